@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""
+Compares two RegexBench JSON files, as written by the bench_json target.
+
+    bench/compare.py old.json new.json [--threshold 10]
+
+Prints the change in CPU time of every benchmark in both files, and of any
+counter that differs (state counts, table sizes), then exits with status 1 if
+anything got slower by more than the threshold percentage, so it can gate a
+change in a script.
+"""
+
+import argparse
+import json
+import sys
+
+# Fields of a benchmark entry that aren't user counters
+BUILTIN = {
+    "name", "family_index", "per_family_instance_index", "run_name",
+    "run_type", "repetitions", "repetition_index", "threads", "iterations",
+    "real_time", "cpu_time", "time_unit", "aggregate_name", "aggregate_unit",
+    "bytes_per_second", "items_per_second", "label", "error_occurred",
+    "error_message", "big_o", "rms", "complexity_n",
+}
+
+
+def load(path):
+    """Benchmark name to entry. The median is used when there were
+    repetitions, otherwise the single run"""
+    with open(path) as f:
+        data = json.load(f)
+
+    runs = {}
+    for bench in data["benchmarks"]:
+        if bench.get("error_occurred") or "cpu_time" not in bench:
+            continue
+        if bench.get("run_type") == "aggregate":
+            if bench.get("aggregate_name") != "median":
+                continue
+        elif bench.get("repetitions", 1) > 1:
+            continue
+        runs[bench.get("run_name", bench["name"])] = bench
+    return runs
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("old")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="percent slowdown counted as a regression")
+    args = parser.parse_args()
+
+    old = load(args.old)
+    new = load(args.new)
+
+    regressions = []
+    width = max((len(name) for name in old.keys() & new.keys()), default=0)
+
+    for name in sorted(old.keys() & new.keys(), key=list(new).index):
+        before = old[name]["cpu_time"]
+        after = new[name]["cpu_time"]
+        change = (after - before) / before * 100 if before else 0.0
+
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions.append(name)
+
+        unit = new[name].get("time_unit", "ns")
+        print(f"{name:<{width}}  {before:12.1f} -> {after:12.1f} {unit}"
+              f"  {change:+7.1f}%{flag}")
+
+        for counter in sorted(new[name].keys() - BUILTIN):
+            if counter in old[name] and old[name][counter] != new[name][counter]:
+                print(f"{'':<{width}}  {counter}: {old[name][counter]:g} -> "
+                      f"{new[name][counter]:g}")
+
+    for name in sorted(old.keys() - new.keys()):
+        print(f"{name}: only in {args.old}")
+    for name in sorted(new.keys() - old.keys()):
+        print(f"{name}: only in {args.new}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower by more than "
+              f"{args.threshold:g}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <variant>
+
+#include "interpreter/Bytecode.hpp"
+#include "interpreter/Eval.hpp"
+#include "interpreter/Lexer.hpp"
+#include "interpreter/Parser.hpp"
+
+namespace {
+
+// Expression with about n operators, nonzero literals and no division so it
+// always evaluates, with parentheses and unary minus mixed in. The tree is
+// mostly one long left spine, and evaluating recurses down it with a stack
+// frame per operator, so n stays modest
+std::string LargeExpression(int n) {
+  std::mt19937 gen(31);
+  std::uniform_int_distribution<int> value(1, 999);
+  std::uniform_int_distribution<int> shape(0, 7);
+  static constexpr char ops[] = "+-*";
+
+  std::string res = std::to_string(value(gen));
+  for (int i = 0; i < n; ++i) {
+    switch (shape(gen)) {
+    case 0:
+      res = "-(" + res + ")";
+      break;
+    case 1:
+      res = "(" + res + ") * " + std::to_string(value(gen));
+      break;
+    default:
+      res += ' ';
+      res += ops[gen() % 3];
+      res += ' ' + std::to_string(value(gen));
+      break;
+    }
+  }
+  return res;
+}
+
+ExprHandle Parse(const std::string &input, Ast &ast) {
+  Lexer lexer(input);
+  Parser parser(lexer.Lex(), ast);
+  return parser.Parse();
+}
+
+} // namespace
+
+// Naive evaluation, std::visit at every node of the tree
+static void BM_EvalTreeWalk(benchmark::State &state) {
+  Ast ast;
+  const ExprHandle root = Parse(LargeExpression(state.range(0)), ast);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(std::visit(AstEvaluator{ast}, ast[root]));
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EvalTreeWalk)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_EvalBytecode(benchmark::State &state) {
+  Ast ast;
+  const ExprHandle root = Parse(LargeExpression(state.range(0)), ast);
+  BytecodeCompiler compiler;
+  const Chunk chunk = compiler.Compile(ast, root);
+  VM vm;
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(vm.Run(chunk));
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["instructions"] = chunk.code.size();
+}
+BENCHMARK(BM_EvalBytecode)->RangeMultiplier(10)->Range(10, 10000);
+
+// What compiling costs, to weigh against how often a chunk gets run
+static void BM_CompileBytecode(benchmark::State &state) {
+  Ast ast;
+  const ExprHandle root = Parse(LargeExpression(state.range(0)), ast);
+  BytecodeCompiler compiler;
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(compiler.Compile(ast, root));
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CompileBytecode)->RangeMultiplier(10)->Range(10, 10000);
@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "interpreter/Lexer.hpp"
+#include "interpreter/Parser.hpp"
+
+namespace {
+
+// A sum of small random terms, about length characters long. Nesting stays
+// shallow so the recursive descent doesn't get deep, whatever the length
+std::string LongExpression(size_t length) {
+  std::mt19937 gen(41);
+  std::uniform_int_distribution<int> value(0, 9999);
+  std::uniform_int_distribution<int> shape(0, 3);
+
+  auto number = [&] { return std::to_string(value(gen)); };
+
+  std::string res = number();
+  while (res.size() < length) {
+    res += gen() % 2 ? " + " : " - ";
+    switch (shape(gen)) {
+    case 0:
+      res += number();
+      break;
+    case 1:
+      res += number();
+      res += " * ";
+      res += number();
+      break;
+    case 2:
+      res += "-(";
+      res += number();
+      res += " - ";
+      res += number();
+      res += ") / ";
+      res += number();
+      break;
+    default:
+      res += '(';
+      res += number();
+      res += " + ";
+      res += number();
+      res += " * -";
+      res += number();
+      res += ')';
+      break;
+    }
+  }
+  return res;
+}
+
+} // namespace
+
+// Lexing alone, into one reserved vector of offsets and values
+static void BM_Lex(benchmark::State &state) {
+  const std::string input = LongExpression(state.range(0));
+  size_t tokens{0};
+
+  for (auto _ : state) {
+    Lexer lexer(input);
+    const std::vector<Token> toks = lexer.Lex();
+    tokens = toks.size();
+    benchmark::DoNotOptimize(toks.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * input.size());
+  state.counters["tokens"] = tokens;
+}
+BENCHMARK(BM_Lex)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Lexing and parsing into a fresh Ast every time, freed all at once when it
+// goes out of scope
+static void BM_Parse(benchmark::State &state) {
+  const std::string input = LongExpression(state.range(0));
+  size_t nodes{0};
+
+  for (auto _ : state) {
+    Lexer lexer(input);
+    Ast ast;
+    Parser parser(lexer.Lex(), ast);
+    benchmark::DoNotOptimize(parser.Parse());
+    nodes = ast.Size();
+  }
+
+  state.SetBytesProcessed(state.iterations() * input.size());
+  state.counters["nodes"] = nodes;
+  state.SetComplexityN(input.size());
+}
+BENCHMARK(BM_Parse)->RangeMultiplier(10)->Range(100, 1000000)->Complexity();
+
+// The same, clearing one Ast between parses, so after the first the pool
+// never allocates
+static void BM_ParseReusingAst(benchmark::State &state) {
+  const std::string input = LongExpression(state.range(0));
+  Ast ast;
+
+  for (auto _ : state) {
+    ast.Clear();
+    Lexer lexer(input);
+    Parser parser(lexer.Lex(), ast);
+    benchmark::DoNotOptimize(parser.Parse());
+  }
+
+  state.SetBytesProcessed(state.iterations() * input.size());
+  state.counters["pool_bytes"] = ast.MemoryUsage();
+}
+BENCHMARK(BM_ParseReusingAst)->RangeMultiplier(10)->Range(100, 1000000);
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "regex/Regex.hpp"
+
+namespace {
+
+// Alternation of random words, big enough that its table is out of L1/L2
+const std::string &Dictionary() {
+  static const std::string dictionary = [] {
+    std::mt19937 gen(21);
+    std::uniform_int_distribution<int> letter('a', 'z');
+
+    std::string res;
+    for (int i = 0; i < 3000; ++i) {
+      if (i > 0)
+        res += '|';
+      for (int j = 0; j < 8; ++j)
+        res += static_cast<char>(letter(gen));
+    }
+    return res;
+  }();
+  return dictionary;
+}
+
+// Tiny records: dictionary words, half with one letter changed, so that
+// every walk goes several states deep
+const std::vector<std::string> &Records() {
+  static const std::vector<std::string> records = [] {
+    std::mt19937 gen(22);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> word(0, 2999);
+    std::uniform_int_distribution<int> position(0, 7);
+
+    std::vector<std::string> res(1 << 18);
+    for (std::string &record : res) {
+      record = Dictionary().substr(word(gen) * 9, 8);
+      if (gen() % 2)
+        record[position(gen)] = static_cast<char>(letter(gen));
+    }
+    return res;
+  }();
+  return records;
+}
+
+} // namespace
+
+static void BM_MatchScalar(benchmark::State &state) {
+  Regex::Matcher reg(Dictionary());
+  const std::vector<std::string> &records = Records();
+  auto results = std::make_unique<bool[]>(records.size());
+
+  for (auto _ : state) {
+    for (uint64_t i = 0; i < records.size(); ++i)
+      results[i] = reg.Match(records[i]);
+    benchmark::DoNotOptimize(results.get());
+  }
+
+  state.SetItemsProcessed(state.iterations() * records.size());
+}
+BENCHMARK(BM_MatchScalar);
+
+// The same, counting match stats, to keep an eye on what they cost
+static void BM_MatchScalarStats(benchmark::State &state) {
+  Regex::Matcher reg(Dictionary());
+  reg.CollectMatchStats(true);
+  const std::vector<std::string> &records = Records();
+  auto results = std::make_unique<bool[]>(records.size());
+
+  for (auto _ : state) {
+    for (uint64_t i = 0; i < records.size(); ++i)
+      results[i] = reg.Match(records[i]);
+    benchmark::DoNotOptimize(results.get());
+  }
+
+  state.SetItemsProcessed(state.iterations() * records.size());
+  state.counters["steps_per_match"] =
+      static_cast<double>(reg.Stats().match.steps) / reg.Stats().match.matches;
+  state.counters["dead_exits"] =
+      static_cast<double>(reg.Stats().match.dead_exits) /
+      reg.Stats().match.matches;
+}
+BENCHMARK(BM_MatchScalarStats);
+
+static void BM_MatchBatch(benchmark::State &state) {
+  Regex::Matcher reg(Dictionary());
+  std::vector<std::string_view> inputs(Records().begin(), Records().end());
+  auto results = std::make_unique<bool[]>(inputs.size());
+
+  for (auto _ : state) {
+    reg.MatchBatch(inputs, {results.get(), inputs.size()});
+    benchmark::DoNotOptimize(results.get());
+  }
+
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+BENCHMARK(BM_MatchBatch);
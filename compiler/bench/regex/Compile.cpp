@@ -0,0 +1,154 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "regex/DFA.hpp"
+#include "regex/FSA.hpp"
+#include "regex/LangFrontend.hpp"
+#include "regex/Regex.hpp"
+
+/*
+ * Compiling a Matcher one phase at a time, over a fixed set of patterns, so a
+ * change to any one phase shows up on its own. Each phase starts from the
+ * output of the one before it, computed once outside the timing loop.
+ */
+
+namespace {
+
+// 64 eight letter words out of a fixed seed, like a small rule set
+std::string Words() {
+  std::mt19937 gen(5);
+  std::uniform_int_distribution<int> letter('a', 'z');
+
+  std::string res;
+  for (int i = 0; i < 64; ++i) {
+    if (i > 0)
+      res += '|';
+    for (int j = 0; j < 8; ++j)
+      res += static_cast<char>(letter(gen));
+  }
+  return res;
+}
+
+const std::vector<std::string> &Patterns() {
+  static const std::vector<std::string> patterns{
+      "a*b(c|d)",
+      "(a|b)*a(a|b)(a|b)(a|b)(a|b)",
+      "[0-9]{1,3}(,[0-9]{3})*",
+      "[a-zA-Z_][a-zA-Z0-9_]*=([0-9]+|'[a-z ]*')",
+      "[a-z0-9]+@[a-z]+(-[a-z]+)?,(com|org|net)",
+      Words(),
+  };
+  return patterns;
+}
+
+FSA Parsed(const std::string &pattern) {
+  Regex::Lexer lex(pattern);
+  Regex::Parser parser(lex.Lex());
+  return parser.Parse();
+}
+
+// Sizes at each phase, reported alongside the time so a regression in state
+// count is as visible as one in speed
+void CountStates(benchmark::State &state, const std::string &pattern) {
+  FSA fsa = Parsed(pattern);
+  state.counters["nfa_states"] = fsa.NumStates();
+  fsa.Determinize();
+  state.counters["dfa_states"] = fsa.NumStates();
+  fsa.Minimize();
+  state.counters["min_states"] = fsa.NumStates();
+}
+
+} // namespace
+
+static void BM_CompileLex(benchmark::State &state) {
+  const std::string &pattern = Patterns()[state.range(0)];
+
+  for (auto _ : state) {
+    Regex::Lexer lex(pattern);
+    benchmark::DoNotOptimize(lex.Lex());
+  }
+
+  state.SetBytesProcessed(state.iterations() * pattern.size());
+}
+BENCHMARK(BM_CompileLex)->DenseRange(0, 5);
+
+static void BM_CompileParse(benchmark::State &state) {
+  const std::string &pattern = Patterns()[state.range(0)];
+  Regex::Lexer lex(pattern);
+  const std::vector<Regex::Token> toks = lex.Lex();
+
+  for (auto _ : state) {
+    Regex::Parser parser(toks);
+    benchmark::DoNotOptimize(parser.Parse());
+  }
+
+  state.SetBytesProcessed(state.iterations() * pattern.size());
+  CountStates(state, pattern);
+}
+BENCHMARK(BM_CompileParse)->DenseRange(0, 5);
+
+static void BM_CompileDeterminize(benchmark::State &state) {
+  const FSA nfa = Parsed(Patterns()[state.range(0)]);
+
+  for (auto _ : state) {
+    FSA fsa = nfa;
+    fsa.Determinize();
+    benchmark::DoNotOptimize(fsa);
+  }
+
+  CompileStats stats;
+  FSA(nfa).Determinize(&stats);
+  state.counters["peak_bytes"] = stats.determinize_peak_bytes;
+  CountStates(state, Patterns()[state.range(0)]);
+}
+BENCHMARK(BM_CompileDeterminize)->DenseRange(0, 5);
+
+static void BM_CompileMinimize(benchmark::State &state) {
+  FSA dfa = Parsed(Patterns()[state.range(0)]);
+  dfa.Determinize();
+
+  for (auto _ : state) {
+    FSA fsa = dfa;
+    fsa.Minimize();
+    benchmark::DoNotOptimize(fsa);
+  }
+
+  CompileStats stats;
+  FSA(dfa).Minimize(&stats);
+  state.counters["peak_bytes"] = stats.minimize_peak_bytes;
+  CountStates(state, Patterns()[state.range(0)]);
+}
+BENCHMARK(BM_CompileMinimize)->DenseRange(0, 5);
+
+static void BM_CompileTable(benchmark::State &state) {
+  FSA minimal = Parsed(Patterns()[state.range(0)]);
+  minimal.Determinize();
+  minimal.Minimize();
+
+  for (auto _ : state) {
+    DFA dfa{minimal};
+    benchmark::DoNotOptimize(dfa);
+  }
+
+  const DFA dfa{minimal};
+  state.counters["classes"] = dfa.Classes().NumClasses();
+  state.counters["table_bytes"] = dfa.MemoryUsage();
+}
+BENCHMARK(BM_CompileTable)->DenseRange(0, 5);
+
+// Everything together, as a caller constructing a Matcher sees it
+static void BM_CompileMatcher(benchmark::State &state) {
+  const std::string &pattern = Patterns()[state.range(0)];
+
+  for (auto _ : state) {
+    Regex::Matcher reg(pattern);
+    benchmark::DoNotOptimize(reg);
+  }
+
+  CountStates(state, pattern);
+}
+BENCHMARK(BM_CompileMatcher)->DenseRange(0, 5);
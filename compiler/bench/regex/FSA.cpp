@@ -0,0 +1,310 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "regex/DFA.hpp"
+#include "regex/FSA.hpp"
+#include "regex/LangFrontend.hpp"
+
+namespace {
+
+// Every word of the given length over the alphabet, as one big alternation.
+// Subset construction turns this into a trie, minimization folds the shared
+// suffixes back together.
+std::string WordAlternation(std::string_view alphabet, size_t length) {
+  std::vector<std::string> words{""};
+  for (size_t i = 0; i < length; ++i) {
+    std::vector<std::string> longer;
+    for (const std::string &word : words) {
+      for (char c : alphabet)
+        longer.push_back(word + c);
+    }
+    words = longer;
+  }
+
+  std::string res = "(";
+  for (const std::string &word : words) {
+    if (res.size() > 1)
+      res += '|';
+    res += word;
+  }
+  return res + ")*";
+}
+
+// n distinct random words as an alternation, like a rule set of literals
+std::string RandomWords(size_t n) {
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<int> letter('a', 'z');
+
+  std::string res;
+  for (size_t i = 0; i < n; ++i) {
+    if (i > 0)
+      res += '|';
+    for (int j = 0; j < 8; ++j)
+      res += static_cast<char>(letter(gen));
+  }
+  return res;
+}
+
+const std::vector<std::string> &Patterns() {
+  static const std::vector<std::string> patterns{
+      "(a|b)*a(a|b)(a|b)(a|b)",
+      WordAlternation("abc", 3),
+      WordAlternation("abcd", 4),
+      "(ab|ac|ad|bb|bc|bd|cb|cc|cd)*(a|b|c|d)",
+  };
+  return patterns;
+}
+
+FSA Determinized(std::string_view expression) {
+  Regex::Lexer lex(expression);
+  Regex::Parser parser(lex.Lex());
+  FSA fsa = parser.Parse();
+  fsa.Determinize();
+  return fsa;
+}
+
+// Fixed corpus of short strings so runs are comparable between builds
+const std::vector<std::string> &Corpus() {
+  static const std::vector<std::string> corpus = [] {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> length(4, 24);
+    std::uniform_int_distribution<int> letter('a', 'd');
+
+    std::vector<std::string> res(4096);
+    for (std::string &str : res) {
+      str.resize(length(gen));
+      for (char &c : str)
+        c = static_cast<char>(letter(gen));
+    }
+    return res;
+  }();
+  return corpus;
+}
+
+void MatchCorpus(benchmark::State &state, const DFA &dfa) {
+  int64_t bytes{0};
+  for (auto _ : state) {
+    for (const std::string &str : Corpus()) {
+      benchmark::DoNotOptimize(dfa.Match(str));
+      bytes += str.size();
+    }
+  }
+  state.SetBytesProcessed(bytes);
+  state.SetItemsProcessed(state.iterations() * Corpus().size());
+  state.counters["states"] = dfa.NumStates();
+}
+
+// [0-9]{1,n} spelled out the long way, with the class as an alternation of
+// digits and the optional copies as a run of x? rather than nested
+std::string NaiveRepetition(uint64_t n) {
+  const std::string digit = "(0|1|2|3|4|5|6|7|8|9)";
+  std::string res = digit;
+  for (uint64_t i = 1; i < n; ++i)
+    res += digit + "?";
+  return res;
+}
+
+// Compiles expression all the way to a DFA, reporting the size of each stage
+void CompileWithCounters(benchmark::State &state,
+                         const std::string &expression) {
+  uint64_t nfa_states{0};
+  uint64_t dfa_states{0};
+  uint64_t arcs{0};
+  size_t table_bytes{0};
+
+  for (auto _ : state) {
+    Regex::Lexer lex(expression);
+    Regex::Parser parser(lex.Lex());
+    FSA fsa = parser.Parse();
+    nfa_states = fsa.NumStates();
+    fsa.Determinize();
+    fsa.Minimize();
+    DFA dfa{fsa};
+
+    dfa_states = fsa.NumStates();
+    arcs = 0;
+    for (uint64_t i = 0; i < fsa.NumStates(); ++i)
+      arcs += fsa.TransitionsFrom(i).size();
+    table_bytes = dfa.MemoryUsage();
+    benchmark::DoNotOptimize(dfa);
+  }
+
+  state.counters["nfa_states"] = nfa_states;
+  state.counters["dfa_states"] = dfa_states;
+  state.counters["arcs"] = arcs;
+  state.counters["table_bytes"] = table_bytes;
+}
+
+// A pattern about length characters long, alternatives of short words with
+// some of them grouped and starred so every construction gets exercised
+std::string LongPattern(size_t length) {
+  std::mt19937 gen(11);
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::uniform_int_distribution<int> shape(0, 3);
+
+  std::string res;
+  while (res.size() < length) {
+    if (!res.empty())
+      res += '|';
+    switch (shape(gen)) {
+    case 0:
+      res += '(';
+      res += static_cast<char>(letter(gen));
+      res += static_cast<char>(letter(gen));
+      res += ")*";
+      break;
+    case 1:
+      res += static_cast<char>(letter(gen));
+      res += "[a-f]+";
+      break;
+    default:
+      for (int i = 0; i < 5; ++i)
+        res += static_cast<char>(letter(gen));
+      break;
+    }
+  }
+  return res;
+}
+
+} // namespace
+
+// Lexing and parsing into an NFA, which should be linear in the length
+static void BM_Parse(benchmark::State &state) {
+  const std::string pattern = LongPattern(state.range(0));
+  uint64_t nfa_states{0};
+
+  for (auto _ : state) {
+    Regex::Lexer lex(pattern);
+    Regex::Parser parser(lex.Lex());
+    FSA fsa = parser.Parse();
+    nfa_states = fsa.NumStates();
+    benchmark::DoNotOptimize(fsa);
+  }
+
+  state.SetBytesProcessed(state.iterations() * pattern.size());
+  state.counters["nfa_states"] = nfa_states;
+  state.SetComplexityN(pattern.size());
+}
+BENCHMARK(BM_Parse)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
+
+// The same sort of pattern folded together with the copying FSA operations,
+// as the parser used to, for comparison
+static void BM_ParseByCopying(benchmark::State &state) {
+  std::mt19937 gen(11);
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::vector<std::string> words(state.range(0) / 6);
+  for (std::string &word : words) {
+    for (int i = 0; i < 5; ++i)
+      word += static_cast<char>(letter(gen));
+  }
+
+  for (auto _ : state) {
+    FSA fsa;
+    for (const std::string &word : words) {
+      FSA concat;
+      for (char c : word) {
+        FSA symbol;
+        symbol.AddStates(2);
+        symbol.AddTransition(0, 1, c);
+        symbol.AcceptState(1);
+        concat = concat.NumStates() == 0 ? symbol
+                                         : FSA::Concatenate(concat, symbol);
+      }
+      fsa = fsa.NumStates() == 0 ? concat : FSA::Union(fsa, concat);
+    }
+    benchmark::DoNotOptimize(fsa);
+  }
+
+  state.SetBytesProcessed(state.iterations() * words.size() * 6);
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ParseByCopying)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000)
+    ->Complexity();
+
+// Compile time and size of the result for [0-9]{1,n}
+static void BM_CompileRepetition(benchmark::State &state) {
+  CompileWithCounters(state,
+                      "[0-9]{1," + std::to_string(state.range(0)) + "}");
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_CompileRepetition)
+    ->RangeMultiplier(4)
+    ->Range(4, 256)
+    ->Complexity();
+
+static void BM_CompileRepetitionNaive(benchmark::State &state) {
+  CompileWithCounters(state, NaiveRepetition(state.range(0)));
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_CompileRepetitionNaive)
+    ->RangeMultiplier(4)
+    ->Range(4, 256)
+    ->Complexity();
+
+// Unicode classes, which become a few byte range sequences each
+static void BM_CompileUnicodeClass(benchmark::State &state) {
+  static const std::vector<std::string> classes{
+      "[α-ω]",
+      "[a-zA-Zà-ÿĀ-ž]",
+      "[一-龥]",
+      "[\x01-\U0010FFFF]",
+  };
+  CompileWithCounters(state, classes[state.range(0)]);
+}
+BENCHMARK(BM_CompileUnicodeClass)->DenseRange(0, 3);
+
+static void BM_Determinize(benchmark::State &state) {
+  Regex::Lexer lex(RandomWords(state.range(0)));
+  Regex::Parser parser(lex.Lex());
+  const FSA nfa = parser.Parse();
+  uint64_t dfa_states{0};
+
+  for (auto _ : state) {
+    FSA dfa = nfa;
+    dfa.Determinize();
+    dfa_states = dfa.NumStates();
+    benchmark::DoNotOptimize(dfa);
+  }
+
+  state.counters["nfa_states"] = nfa.NumStates();
+  state.counters["dfa_states"] = dfa_states;
+  state.SetComplexityN(dfa_states);
+}
+BENCHMARK(BM_Determinize)->RangeMultiplier(4)->Range(16, 1024)->Complexity();
+
+static void BM_Minimize(benchmark::State &state) {
+  const FSA dfa = Determinized(Patterns()[state.range(0)]);
+  uint64_t min_states{0};
+
+  for (auto _ : state) {
+    FSA minimal = dfa;
+    minimal.Minimize();
+    min_states = minimal.NumStates();
+    benchmark::DoNotOptimize(minimal);
+  }
+
+  state.counters["dfa_states"] = dfa.NumStates();
+  state.counters["min_states"] = min_states;
+}
+BENCHMARK(BM_Minimize)->DenseRange(0, 3);
+
+static void BM_MatchDeterminized(benchmark::State &state) {
+  const DFA dfa{Determinized(Patterns()[state.range(0)])};
+  MatchCorpus(state, dfa);
+}
+BENCHMARK(BM_MatchDeterminized)->DenseRange(0, 3);
+
+static void BM_MatchMinimized(benchmark::State &state) {
+  FSA fsa = Determinized(Patterns()[state.range(0)]);
+  fsa.Minimize();
+  const DFA dfa{fsa};
+  MatchCorpus(state, dfa);
+}
+BENCHMARK(BM_MatchMinimized)->DenseRange(0, 3);
@@ -0,0 +1,117 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "regex/PatternSet.hpp"
+#include "regex/Regex.hpp"
+
+namespace {
+
+// Rule-like patterns: a literal word, optionally followed by repeats of a
+// short suffix alternation
+const std::vector<std::string> &Patterns() {
+  static const std::vector<std::string> patterns = [] {
+    std::mt19937 gen(13);
+    std::uniform_int_distribution<int> letter('a', 'h');
+
+    std::vector<std::string> res(256);
+    for (std::string &pattern : res) {
+      for (int i = 0; i < 4; ++i)
+        pattern += static_cast<char>(letter(gen));
+      pattern += "(";
+      pattern += static_cast<char>(letter(gen));
+      pattern += "|";
+      pattern += static_cast<char>(letter(gen));
+      pattern += ")*";
+    }
+    return res;
+  }();
+  return patterns;
+}
+
+const std::vector<std::string> &Records() {
+  static const std::vector<std::string> records = [] {
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<int> letter('a', 'h');
+    std::uniform_int_distribution<int> length(4, 12);
+
+    std::vector<std::string> res(1024);
+    for (std::string &record : res) {
+      record.resize(length(gen));
+      for (char &c : record)
+        c = static_cast<char>(letter(gen));
+    }
+    return res;
+  }();
+  return records;
+}
+
+} // namespace
+
+static void BM_PatternSet(benchmark::State &state) {
+  std::vector<std::string_view> patterns(Patterns().begin(),
+                                         Patterns().begin() + state.range(0));
+  Regex::PatternSet set(patterns);
+
+  for (auto _ : state) {
+    for (const std::string &record : Records())
+      benchmark::DoNotOptimize(set.Match(record));
+  }
+
+  state.SetItemsProcessed(state.iterations() * Records().size());
+  state.counters["bytes"] = set.MemoryUsage();
+}
+BENCHMARK(BM_PatternSet)->RangeMultiplier(4)->Range(4, 256);
+
+static void BM_MatcherPerPattern(benchmark::State &state) {
+  std::vector<Regex::Matcher> matchers;
+  for (int64_t i = 0; i < state.range(0); ++i)
+    matchers.emplace_back(Patterns()[i]);
+
+  std::vector<uint64_t> matched;
+  for (auto _ : state) {
+    for (const std::string &record : Records()) {
+      matched.clear();
+      for (uint64_t id = 0; id < matchers.size(); ++id) {
+        if (matchers[id].Match(record))
+          matched.push_back(id);
+      }
+      benchmark::DoNotOptimize(matched);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * Records().size());
+}
+BENCHMARK(BM_MatcherPerPattern)->RangeMultiplier(4)->Range(4, 256);
+
+// Startup cost: compiling the set from source versus mapping a saved one
+static void BM_PatternSetCompile(benchmark::State &state) {
+  std::vector<std::string_view> patterns(Patterns().begin(),
+                                         Patterns().begin() + state.range(0));
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(Regex::PatternSet(patterns));
+}
+BENCHMARK(BM_PatternSetCompile)->RangeMultiplier(4)->Range(4, 256);
+
+static void BM_PatternSetMap(benchmark::State &state) {
+  std::vector<std::string_view> patterns(Patterns().begin(),
+                                         Patterns().begin() + state.range(0));
+  const std::string path = "pattern_set_bench.dfa";
+  {
+    std::ofstream out(path, std::ios::binary);
+    Regex::PatternSet(patterns).Save(out);
+  }
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(Regex::MappedMatcher(path));
+
+  std::remove(path.c_str());
+}
+BENCHMARK(BM_PatternSetMap)->RangeMultiplier(4)->Range(4, 256);
@@ -0,0 +1,123 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "regex/Regex.hpp"
+
+namespace {
+
+// 1MiB of random lowercase text with a few planted occurrences of needle
+const std::string &Haystack() {
+  static const std::string haystack = [] {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> letter('a', 'z');
+
+    std::string res(1 << 20, ' ');
+    for (char &c : res)
+      c = static_cast<char>(letter(gen));
+
+    for (size_t i = 1000; i + 16 < res.size(); i += 100000)
+      res.replace(i, 12, "needlessness");
+
+    return res;
+  }();
+  return haystack;
+}
+
+} // namespace
+
+static void BM_Find(benchmark::State &state) {
+  Regex::Matcher reg("needle(s)*ness");
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(reg.Find(Haystack()));
+
+  state.SetBytesProcessed(state.iterations() * Haystack().size());
+}
+BENCHMARK(BM_Find);
+
+static void BM_FindAll(benchmark::State &state) {
+  Regex::Matcher reg("needle(s)*ness");
+  size_t matches{0};
+
+  for (auto _ : state) {
+    auto found = reg.FindAll(Haystack());
+    matches = found.size();
+    benchmark::DoNotOptimize(found);
+  }
+
+  state.SetBytesProcessed(state.iterations() * Haystack().size());
+  state.counters["matches"] = matches;
+}
+BENCHMARK(BM_FindAll);
+
+static void BM_FindAllNoMatch(benchmark::State &state) {
+  Regex::Matcher reg("qq(x|z)*qq");
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(reg.FindAll(Haystack()));
+
+  state.SetBytesProcessed(state.iterations() * Haystack().size());
+}
+BENCHMARK(BM_FindAllNoMatch);
+
+// Chunk size as the argument, compare against BM_FindAll
+static void BM_ParallelFindAll(benchmark::State &state) {
+  Regex::Matcher reg("needle(s)*ness");
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(reg.ParallelFindAll(Haystack(), state.range(0)));
+
+  state.SetBytesProcessed(state.iterations() * Haystack().size());
+}
+BENCHMARK(BM_ParallelFindAll)->RangeMultiplier(4)->Range(1 << 14, 1 << 18);
+
+static void BM_ParallelMatch(benchmark::State &state) {
+  Regex::Matcher reg("(a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|w|x|y|z)*"
+                     "needless(a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|"
+                     "w|x|y|z)*");
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(reg.ParallelMatch(Haystack(), state.range(0)));
+
+  state.SetBytesProcessed(state.iterations() * Haystack().size());
+}
+BENCHMARK(BM_ParallelMatch)->RangeMultiplier(4)->Range(1 << 14, 1 << 18);
+
+static void BM_SerialMatch(benchmark::State &state) {
+  Regex::Matcher reg("(a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|w|x|y|z)*"
+                     "needless(a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|"
+                     "w|x|y|z)*");
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(reg.Match(Haystack()));
+
+  state.SetBytesProcessed(state.iterations() * Haystack().size());
+}
+BENCHMARK(BM_SerialMatch);
+
+// Whole-line match with and without reporting groups
+static void BM_MatchCaptures(benchmark::State &state) {
+  Regex::Matcher reg("(a|b|c|d|e|f)*(x)((a|b|c|d|e|f)*)");
+  std::string line(1 << 12, 'a');
+  for (size_t i = 0; i < line.size(); ++i)
+    line[i] = static_cast<char>('a' + i % 6);
+  line[line.size() / 2] = 'x';
+  std::vector<std::optional<MatchSpan>> groups(reg.NumGroups());
+
+  for (auto _ : state) {
+    if (state.range(0))
+      benchmark::DoNotOptimize(reg.Match(line, groups));
+    else
+      benchmark::DoNotOptimize(reg.Match(line));
+  }
+
+  state.SetBytesProcessed(state.iterations() * line.size());
+}
+BENCHMARK(BM_MatchCaptures)->Arg(0)->Arg(1);
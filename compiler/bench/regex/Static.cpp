@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "regex/Regex.hpp"
+#include "regex/StaticRegex.hpp"
+
+namespace {
+
+// Identifiers, hex literals and decimals, like a lexer's token classes
+using Token = Regex::StaticMatcher<
+    "[a-zA-Z_][a-zA-Z0-9_]*|0x[0-9a-fA-F]+|[0-9]+(.[0-9]+)?">;
+
+// Short strings drawn from the same characters, about half of them tokens
+const std::vector<std::string> &Words() {
+  static const std::vector<std::string> words = [] {
+    static constexpr std::string_view chars = "abcxyzAZ_0123456789.x";
+    std::mt19937 gen(23);
+    std::uniform_int_distribution<size_t> letter(0, chars.size() - 1);
+    std::uniform_int_distribution<int> length(1, 12);
+
+    std::vector<std::string> res(1 << 16);
+    for (std::string &word : res) {
+      word.resize(length(gen));
+      for (char &c : word)
+        c = chars[letter(gen)];
+    }
+    return res;
+  }();
+  return words;
+}
+
+template <typename Match>
+void MatchWords(benchmark::State &state, Match match) {
+  const std::vector<std::string> &words = Words();
+  auto results = std::make_unique<bool[]>(words.size());
+
+  for (auto _ : state) {
+    for (uint64_t i = 0; i < words.size(); ++i)
+      results[i] = match(words[i]);
+    benchmark::DoNotOptimize(results.get());
+  }
+
+  state.SetItemsProcessed(state.iterations() * words.size());
+}
+
+} // namespace
+
+// Table built by the compiler, with its dimensions inlined into the loop
+static void BM_MatchStatic(benchmark::State &state) {
+  MatchWords(state, [](std::string_view word) { return Token::Match(word); });
+  state.counters["states"] = Token::NumStates();
+  state.counters["table_bytes"] = Token::MemoryUsage();
+}
+BENCHMARK(BM_MatchStatic);
+
+// The same pattern through a Matcher built at runtime
+static void BM_MatchRuntime(benchmark::State &state) {
+  Regex::Matcher reg(Token::Expression());
+  MatchWords(state, [&](std::string_view word) { return reg.Match(word); });
+  state.counters["states"] = reg.Stats().compile.min_states;
+}
+BENCHMARK(BM_MatchRuntime);
+
+// What a StaticMatcher saves at startup
+static void BM_StartupRuntime(benchmark::State &state) {
+  for (auto _ : state) {
+    Regex::Matcher reg(Token::Expression());
+    benchmark::DoNotOptimize(reg);
+  }
+}
+BENCHMARK(BM_StartupRuntime);
@@ -0,0 +1,137 @@
+#include "Bytecode.hpp"
+#include "Eval.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <variant>
+
+void BytecodeCompiler::Error(std::string_view msg) {
+  std::cout << "Compile error: " << msg << '\n';
+  throw CompileError{};
+}
+
+void BytecodeCompiler::Emit(OpCode op, int32_t operand) {
+  chunk.code.push_back({op, operand});
+
+  switch (op) {
+  case OpCode::Push:
+    ++depth;
+    break;
+  case OpCode::Add:
+  case OpCode::Subtract:
+  case OpCode::Multiply:
+  case OpCode::Divide:
+  case OpCode::Return:
+    --depth;
+    break;
+  case OpCode::AddConst:
+  case OpCode::SubtractConst:
+  case OpCode::MultiplyConst:
+  case OpCode::DivideConst:
+  case OpCode::Negate:
+    break;
+  }
+
+  chunk.max_stack = std::max(chunk.max_stack, depth);
+}
+
+void BytecodeCompiler::Expression(ExprHandle expr) {
+  if (expr == NoExpr)
+    Error("Missing operand");
+
+  const Expr &node = (*ast)[expr];
+  if (const auto *binary = std::get_if<BinaryExpr>(&node)) {
+    Binary(*binary);
+  } else if (const auto *unary = std::get_if<UnaryExpr>(&node)) {
+    Expression(unary->operand);
+    Emit(OpCode::Negate);
+  } else {
+    Emit(OpCode::Push, std::get<IntegerLit>(node).value);
+  }
+}
+
+void BytecodeCompiler::Binary(const BinaryExpr &expr) {
+  Expression(expr.left);
+
+  const IntegerLit *lit = expr.right != NoExpr
+                              ? std::get_if<IntegerLit>(&(*ast)[expr.right])
+                              : nullptr;
+  if (!lit)
+    Expression(expr.right);
+
+  switch (expr.op) {
+  case Plus:
+    lit ? Emit(OpCode::AddConst, lit->value) : Emit(OpCode::Add);
+    break;
+  case Minus:
+    lit ? Emit(OpCode::SubtractConst, lit->value) : Emit(OpCode::Subtract);
+    break;
+  case Star:
+    lit ? Emit(OpCode::MultiplyConst, lit->value) : Emit(OpCode::Multiply);
+    break;
+  case Slash:
+    lit ? Emit(OpCode::DivideConst, lit->value) : Emit(OpCode::Divide);
+    break;
+  default:
+    Error("Bad binary operator " + FormatTokenType(expr.op));
+  }
+}
+
+Chunk BytecodeCompiler::Compile(const Ast &ast, ExprHandle expr) {
+  this->ast = &ast;
+  chunk = {};
+  depth = 0;
+
+  Expression(expr);
+  Emit(OpCode::Return);
+
+  return std::move(chunk);
+}
+
+int VM::Run(const Chunk &chunk) {
+  if (stack.size() < chunk.max_stack)
+    stack.resize(chunk.max_stack);
+
+  // The top of the stack, with everything under it in stack up to top
+  int acc{0};
+  int *top = stack.data();
+
+  for (const Instruction *ip = chunk.code.data();; ++ip) {
+    switch (ip->op) {
+    case OpCode::Push:
+      *top++ = acc;
+      acc = ip->operand;
+      break;
+    case OpCode::Add:
+      acc = WrappingAdd(*--top, acc);
+      break;
+    case OpCode::Subtract:
+      acc = WrappingSubtract(*--top, acc);
+      break;
+    case OpCode::Multiply:
+      acc = WrappingMultiply(*--top, acc);
+      break;
+    case OpCode::Divide:
+      acc = WrappingDivide(*--top, acc);
+      break;
+    case OpCode::AddConst:
+      acc = WrappingAdd(acc, ip->operand);
+      break;
+    case OpCode::SubtractConst:
+      acc = WrappingSubtract(acc, ip->operand);
+      break;
+    case OpCode::MultiplyConst:
+      acc = WrappingMultiply(acc, ip->operand);
+      break;
+    case OpCode::DivideConst:
+      acc = WrappingDivide(acc, ip->operand);
+      break;
+    case OpCode::Negate:
+      acc = WrappingNegate(acc);
+      break;
+    case OpCode::Return:
+      return acc;
+    }
+  }
+}
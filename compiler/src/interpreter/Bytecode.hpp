@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Parser.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/*
+ * Stack bytecode for expressions. Compiling flattens the tree into postorder,
+ * operands before their operator, so running it is one pass over a flat array
+ * with no pointer chasing, recursion or variant dispatch per node. Every
+ * instruction is 8 bytes, and the deepest the stack can get is worked out
+ * while compiling so the VM never has to grow or check it. The VM keeps the
+ * top of the stack in a local, so most instructions don't touch memory.
+ */
+
+enum class OpCode : uint8_t {
+  // Push operand
+  Push,
+  // Pop b, pop a, push a op b
+  Add,
+  Subtract,
+  Multiply,
+  Divide,
+  // Pop a, push a op operand. Most right operands are literals, and fusing
+  // the push into the operator halves the instructions dispatched for them
+  AddConst,
+  SubtractConst,
+  MultiplyConst,
+  DivideConst,
+  // Pop a, push -a
+  Negate,
+  // Pop the result and stop
+  Return,
+};
+
+struct Instruction {
+  OpCode op;
+  int32_t operand{0};
+};
+
+struct Chunk {
+  std::vector<Instruction> code;
+  uint32_t max_stack{0};
+};
+
+struct CompileError {};
+
+class BytecodeCompiler {
+private:
+  const Ast *ast{nullptr};
+  Chunk chunk;
+  uint32_t depth{0};
+
+  void Error(std::string_view msg);
+
+  void Emit(OpCode op, int32_t operand = 0);
+
+  void Expression(ExprHandle expr);
+
+  void Binary(const BinaryExpr &expr);
+
+public:
+  // May throw a CompileError if the tree is missing an operand, as the parser
+  // leaves it for input like "1 +"
+  Chunk Compile(const Ast &ast, ExprHandle expr);
+};
+
+class VM {
+private:
+  std::vector<int> stack;
+
+public:
+  /*
+   * Evaluates chunk, with the same results as AstEvaluator. Dispatches with a
+   * switch per instruction. May throw an EvalError
+   */
+  int Run(const Chunk &chunk);
+};
@@ -0,0 +1,8 @@
+#include "Eval.hpp"
+
+#include <iostream>
+
+void EvalFail(std::string_view msg) {
+  std::cout << "Eval error: " << msg << '\n';
+  throw EvalError{};
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Parser.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <variant>
+
+/*
+ * Integer arithmetic shared by every way of evaluating an expression, so the
+ * tree walker and the bytecode VM always agree. Values are ints that wrap
+ * around on overflow instead of being undefined, and dividing by zero is an
+ * EvalError.
+ */
+
+struct EvalError {};
+
+// Prints msg and throws an EvalError
+[[noreturn]] void EvalFail(std::string_view msg);
+
+inline int WrappingAdd(int a, int b) {
+  return static_cast<int>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b));
+}
+
+inline int WrappingSubtract(int a, int b) {
+  return static_cast<int>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));
+}
+
+inline int WrappingMultiply(int a, int b) {
+  return static_cast<int>(static_cast<uint32_t>(a) * static_cast<uint32_t>(b));
+}
+
+inline int WrappingNegate(int a) {
+  return static_cast<int>(0u - static_cast<uint32_t>(a));
+}
+
+// Truncates toward zero, and INT_MIN / -1 wraps around to INT_MIN
+inline int WrappingDivide(int a, int b) {
+  if (b == 0)
+    EvalFail("Division by zero");
+  if (b == -1)
+    return WrappingNegate(a);
+  return a / b;
+}
+
+/*
+ * Reference evaluator, walking the tree with std::visit the same way
+ * AstPrinter does
+ */
+struct AstEvaluator {
+  const Ast &ast;
+
+  int operator()(const BinaryExpr &expr) {
+    if (expr.left == NoExpr || expr.right == NoExpr)
+      EvalFail("Missing operand");
+
+    const int left = std::visit(*this, ast[expr.left]);
+    const int right = std::visit(*this, ast[expr.right]);
+
+    switch (expr.op) {
+    case Plus:
+      return WrappingAdd(left, right);
+    case Minus:
+      return WrappingSubtract(left, right);
+    case Star:
+      return WrappingMultiply(left, right);
+    case Slash:
+      return WrappingDivide(left, right);
+    default:
+      EvalFail("Bad binary operator " + FormatTokenType(expr.op));
+    }
+  }
+  int operator()(const UnaryExpr &expr) {
+    if (expr.operand == NoExpr)
+      EvalFail("Missing operand");
+    return WrappingNegate(std::visit(*this, ast[expr.operand]));
+  }
+  int operator()(const IntegerLit &lit) { return lit.value; }
+};
@@ -1,11 +1,14 @@
 #include "Lexer.hpp"
 
 #include <cassert>
+#include <climits>
+#include <cstdint>
 #include <format>
 #include <iostream>
+#include <utility>
 
-Token::Token(TokenType type, std::string lexeme) : type(type), lexeme(lexeme) {}
-Token::Token(TokenType type) : type(type), lexeme("") {}
+Token::Token(TokenType type, uint32_t offset, uint32_t length, int value)
+    : type(type), offset(offset), length(length), value(value) {}
 
 // enum TokenType { LeftParen, RightParen, Plus, Minus, Star, Slash, Integer,
 std::string FormatTokenType(TokenType type) {
@@ -40,37 +43,47 @@ void Lexer::Error(std::string_view message) {
 }
 
 void Lexer::Integer() {
-  std::string::const_iterator start = current - 1;
+  std::string_view::const_iterator start = current - 1;
+  int64_t value = *start - '0';
 
   while (current != input.end() && *current >= '0' && *current <= '9') {
+    value = value * 10 + (*current - '0');
+    if (value > INT_MAX)
+      Error("Integer literal too large");
     ++current;
   }
 
-  toks.emplace_back(TokenType::Integer, std::string(start, current));
+  toks.emplace_back(TokenType::Integer, start - input.begin(), current - start,
+                    static_cast<int>(value));
 }
 
 std::vector<Token> Lexer::Lex() {
+  if (input.size() > UINT32_MAX)
+    Error("Input too long");
+  toks.reserve(input.size() / 2 + 1);
+
   while (current != input.end()) {
+    const uint32_t offset = current - input.begin();
     char cur = *(current++);
 
     switch (cur) {
     case '(':
-      toks.emplace_back(TokenType::LeftParen);
+      toks.emplace_back(TokenType::LeftParen, offset, 1);
       break;
     case ')':
-      toks.emplace_back(TokenType::RightParen);
+      toks.emplace_back(TokenType::RightParen, offset, 1);
       break;
     case '+':
-      toks.emplace_back(TokenType::Plus);
+      toks.emplace_back(TokenType::Plus, offset, 1);
       break;
     case '-':
-      toks.emplace_back(TokenType::Minus);
+      toks.emplace_back(TokenType::Minus, offset, 1);
       break;
     case '*':
-      toks.emplace_back(TokenType::Star);
+      toks.emplace_back(TokenType::Star, offset, 1);
       break;
     case '/':
-      toks.emplace_back(TokenType::Slash);
+      toks.emplace_back(TokenType::Slash, offset, 1);
       break;
     case ' ':
       break;
@@ -84,5 +97,5 @@ std::vector<Token> Lexer::Lex() {
     }
   }
 
-  return toks;
+  return std::move(toks);
 }
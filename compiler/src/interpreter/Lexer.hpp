@@ -1,30 +1,41 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 enum TokenType { LeftParen, RightParen, Plus, Minus, Star, Slash, Integer };
 std::string FormatTokenType(TokenType type);
 
+/*
+ * Where in the source a token is, rather than a copy of it, so lexing
+ * allocates nothing per token. Integers come out already converted.
+ */
 struct Token {
   TokenType type;
-  std::string lexeme;
+  uint32_t offset;
+  uint32_t length;
+  // Only for Integer tokens
+  int value{0};
 
-  Token(TokenType type, std::string lexeme);
-  Token(TokenType type);
+  Token(TokenType type, uint32_t offset, uint32_t length, int value = 0);
+
+  std::string_view Lexeme(std::string_view source) const {
+    return source.substr(offset, length);
+  }
 };
 
 struct LexError {};
 
 class Lexer {
 private:
-  std::string input;
-  std::string::const_iterator current;
+  // Borrowed, the caller keeps it alive while lexing
+  std::string_view input;
+  std::string_view::const_iterator current;
 
   std::vector<Token> toks;
 
-  void AddToken(TokenType type);
-
   void Integer();
 
   void Error(std::string_view message);
@@ -32,5 +43,9 @@ private:
 public:
   Lexer(std::string_view input);
 
+  // Tokens go into a vector reserved for one per two input characters, as in
+  // "1 + 2", so it seldom grows; the worst case of one per character would
+  // reserve 16 bytes per input byte. May throw a LexError, including for
+  // integers too large for an int
   std::vector<Token> Lex();
 };
@@ -0,0 +1,26 @@
+#include "Bytecode.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <variant>
+
+int main() {
+	std::string input = "(2 * 3) + 4";
+	Lexer lexer(input);
+	auto lexed = lexer.Lex();
+	Ast ast;
+	Parser parser(std::move(lexed), ast);
+	ExprHandle ast_root = parser.Parse();
+
+	std::cout << "Input String: " <<  input << '\n';
+	const std::string printed = std::visit(AstPrinter{ast}, ast[ast_root]);
+	std::cout << "Output AST: " << printed << '\n';
+
+	BytecodeCompiler compiler;
+	VM vm;
+	const Chunk chunk = compiler.Compile(ast, ast_root);
+	std::cout << "Value: " << vm.Run(chunk) << '\n';
+}
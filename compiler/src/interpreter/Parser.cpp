@@ -1,8 +1,10 @@
 #include "Parser.hpp"
 
 #include <iostream>
+#include <utility>
 
-Parser::Parser(std::vector<Token> toks) : toks(toks) {
+Parser::Parser(std::vector<Token> toks, Ast &ast)
+    : toks(std::move(toks)), ast(ast) {
   this->current = this->toks.begin();
 }
 
@@ -22,7 +24,7 @@ ExprHandle Parser::Term() {
     ++current;
 
     ExprHandle right = Factor();
-    expr = std::make_shared<Expr>(BinaryExpr{op, expr, right});
+    expr = ast.Add(BinaryExpr{op, expr, right});
   }
 
   return expr;
@@ -37,7 +39,7 @@ ExprHandle Parser::Factor() {
     ++current;
 
     ExprHandle right = Unary();
-    expr = std::make_shared<Expr>(BinaryExpr{op, expr, right});
+    expr = ast.Add(BinaryExpr{op, expr, right});
   }
 
   return expr;
@@ -48,7 +50,7 @@ ExprHandle Parser::Unary() {
     TokenType op = current->type;
     ++current;
 
-    return std::make_shared<Expr>(UnaryExpr{op, Unary()});
+    return ast.Add(UnaryExpr{op, Unary()});
   } else {
     return Primary();
   }
@@ -56,13 +58,12 @@ ExprHandle Parser::Unary() {
 
 ExprHandle Parser::Primary() {
   if (current == toks.end()) {
-    return nullptr;
+    return NoExpr;
   }
 
   if (current->type == TokenType::Integer) {
 
-    ExprHandle val =
-        std::make_shared<Expr>(IntegerLit{std::stoi(current->lexeme)});
+    ExprHandle val = ast.Add(IntegerLit{current->value});
     ++current;
     return val;
   }
@@ -79,20 +80,12 @@ ExprHandle Parser::Primary() {
     return expr;
   }
 
-  return nullptr;
+  return NoExpr;
 }
 
-ExprHandle Parser::Parse() { return Expression(); }
-
-
-int main() {
-	std::string input = "(2 * 3) + 4";
-	Lexer lexer(input);
-	auto lexed = lexer.Lex();
-	Parser parser(lexed);
-	ExprHandle ast_root = parser.Parse();
-
-	std::cout << "Input String: " <<  input << '\n';
-	std::cout << "Output AST: " << std::visit(AstPrinter{}, *ast_root) << '\n';
-
+// Every node takes at least one token, so the pool grows at most once
+ExprHandle Parser::Parse() {
+  ast.Reserve(ast.Size() + toks.size());
+  return Expression();
 }
+
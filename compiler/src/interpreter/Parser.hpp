@@ -2,8 +2,12 @@
 
 #include "Lexer.hpp"
 
-#include <memory>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <variant>
+#include <vector>
 
 // build a simple interpreter where all variables are float and all declarations are global
 
@@ -44,7 +48,12 @@ struct UnaryExpr;
 struct IntegerLit;
 
 using Expr = std::variant<BinaryExpr, UnaryExpr, IntegerLit>;
-using ExprHandle = std::shared_ptr<Expr>;
+
+// Index of a node in its Ast
+using ExprHandle = uint32_t;
+
+// Missing subexpression, where the parser found no operand
+constexpr ExprHandle NoExpr{UINT32_MAX};
 
 struct BinaryExpr {
   TokenType op;
@@ -61,6 +70,36 @@ struct IntegerLit {
   int value;
 };
 
+/*
+ * Every node of a tree in one contiguous pool, children referring to each
+ * other by index. Adding a node is a bump at the end of the pool, and since
+ * children are always added before their parents, a traversal mostly walks
+ * memory backwards in order. There are no per-node lifetimes: Clear frees the
+ * whole tree at once and keeps the memory for the next one.
+ */
+class Ast {
+private:
+  std::vector<Expr> nodes;
+
+public:
+  ExprHandle Add(Expr expr) {
+    assert(nodes.size() < NoExpr);
+    nodes.push_back(expr);
+    return static_cast<ExprHandle>(nodes.size() - 1);
+  }
+
+  const Expr &operator[](ExprHandle handle) const { return nodes[handle]; }
+
+  size_t Size() const { return nodes.size(); }
+
+  void Reserve(size_t n) { nodes.reserve(n); }
+
+  void Clear() { nodes.clear(); }
+
+  // Bytes held by the pool, including capacity kept after Clear
+  size_t MemoryUsage() const { return nodes.capacity() * sizeof(Expr); }
+};
+
 struct ParseError {};
 
 class Parser {
@@ -68,6 +107,8 @@ private:
   std::vector<Token> toks;
   std::vector<Token>::const_iterator current;
 
+  Ast &ast;
+
   void Error(std::string_view msg);
 
   ExprHandle Expression();
@@ -77,20 +118,23 @@ private:
   ExprHandle Primary();
 
 public:
-  Parser(std::vector<Token> toks);
+  // Nodes are added to ast, which must outlive the handles Parse returns
+  Parser(std::vector<Token> toks, Ast &ast);
 
   ExprHandle Parse();
 };
 
 struct AstPrinter {
+  const Ast &ast;
+
   std::string operator()(const BinaryExpr &expr) {
     return "BinaryExpr " + FormatTokenType(expr.op) + " (" +
-           std::visit(AstPrinter{}, *expr.left) + ") (" +
-           std::visit(AstPrinter{}, *expr.right) + ")";
+           std::visit(*this, ast[expr.left]) + ") (" +
+           std::visit(*this, ast[expr.right]) + ")";
   }
   std::string operator()(const UnaryExpr &expr) {
     return "UnaryExpr " + FormatTokenType(expr.op) + " (" +
-           std::visit(AstPrinter{}, *expr.operand) + ")";
+           std::visit(*this, ast[expr.operand]) + ")";
   }
   std::string operator()(const IntegerLit &lit) {
     return "IntegerLit " + std::to_string(lit.value);
@@ -0,0 +1,73 @@
+#include "ByteClasses.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/*
+ * Refine the partition one state at a time. Each byte gets a signature for
+ * the state, the id of the set of states it leads to, and the new class of a
+ * byte is its (old class, signature) pair. Classes are numbered by their
+ * smallest byte so the result doesn't depend on the order states are visited
+ * in beyond the partition itself.
+ */
+ByteClasses::ByteClasses(const FSA &fsa) {
+  std::array<std::vector<uint64_t>, AlphabetSize> targets;
+  std::array<uint16_t, AlphabetSize> signatures;
+  std::vector<uint16_t> renumber(AlphabetSize * (AlphabetSize + 1), UINT16_MAX);
+  std::vector<uint64_t> touched;
+
+  for (uint64_t state = 0; state < fsa.NumStates(); ++state) {
+    std::vector<uint8_t> used;
+    for (const FSA::Transition &trans : fsa.TransitionsFrom(state)) {
+      if (trans.label < 0 || trans.hi >= static_cast<int64_t>(AlphabetSize))
+        continue;
+      for (int64_t byte = trans.label; byte <= trans.hi; ++byte) {
+        if (targets[byte].empty())
+          used.push_back(byte);
+        targets[byte].push_back(trans.to);
+      }
+    }
+
+    if (used.empty())
+      continue;
+
+    // Signature 0 is no transition at all
+    std::map<std::vector<uint64_t>, uint16_t> ids;
+    signatures.fill(0);
+    for (uint8_t byte : used) {
+      std::vector<uint64_t> &to = targets[byte];
+      std::sort(to.begin(), to.end());
+      to.erase(std::unique(to.begin(), to.end()), to.end());
+      signatures[byte] = ids.try_emplace(to, ids.size() + 1).first->second;
+    }
+    for (uint8_t byte : used)
+      targets[byte].clear();
+
+    uint64_t count = 0;
+    for (uint64_t byte = 0; byte < AlphabetSize; ++byte) {
+      const uint64_t key =
+          classes[byte] * (AlphabetSize + 1) + signatures[byte];
+      if (renumber[key] == UINT16_MAX) {
+        renumber[key] = count++;
+        touched.push_back(key);
+      }
+      classes[byte] = renumber[key];
+    }
+
+    for (uint64_t key : touched)
+      renumber[key] = UINT16_MAX;
+    touched.clear();
+    num_classes = count;
+  }
+}
+
+std::array<uint8_t, ByteClasses::AlphabetSize>
+ByteClasses::Representatives() const {
+  std::array<uint8_t, AlphabetSize> res{};
+  for (uint64_t byte = AlphabetSize; byte-- > 0;)
+    res[classes[byte]] = byte;
+  return res;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "FSA.hpp"
+
+/*
+ * Partition of the 256 byte values into classes that no state of an FSA can
+ * tell apart: two bytes share a class when every state has the same
+ * transitions on both. Tables indexed by class instead of byte are as many
+ * times smaller as there are bytes per class, which for typical patterns
+ * (a few literals, everything else treated alike) is most of them.
+ */
+class ByteClasses {
+public:
+  static constexpr uint64_t AlphabetSize{256};
+
+private:
+  std::array<uint8_t, AlphabetSize> classes{};
+  uint64_t num_classes{1};
+
+public:
+  // Every byte in a single class
+  ByteClasses() = default;
+
+  explicit ByteClasses(const FSA &fsa);
+
+  uint8_t operator[](uint8_t byte) const { return classes[byte]; }
+
+  uint64_t NumClasses() const { return num_classes; }
+
+  // Smallest byte in each class, indexed by class
+  std::array<uint8_t, AlphabetSize> Representatives() const;
+};
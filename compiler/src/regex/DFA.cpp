@@ -0,0 +1,208 @@
+#include "DFA.hpp"
+#include "DFAFile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <set>
+#include <span>
+#include <string_view>
+
+DFA::DFA()
+    : table(1, Dead), accept_states(1, 0), tag_offsets(2, 0) {}
+
+DFA::DFA(const FSA &fsa) : classes(fsa) {
+  const uint64_t n_states = fsa.NumStates() + 1;
+  const uint64_t stride = classes.NumClasses();
+
+  table.assign(n_states * stride, Dead);
+  accept_states.assign((n_states + 63) / 64, 0);
+  tag_offsets.assign(2, 0);
+
+  if (fsa.NumStates() == 0)
+    return;
+
+  start_state = fsa.StartState() + 1;
+
+  for (uint64_t state = 0; state < fsa.NumStates(); ++state) {
+    const uint64_t row = (state + 1) * stride;
+
+    // Every byte of a class has the same transition, so writing the class's
+    // entry once per byte is harmless
+    for (const FSA::Transition &trans : fsa.TransitionsFrom(state)) {
+      assert(trans.label >= 0 &&
+             static_cast<uint64_t>(trans.hi) < AlphabetSize);
+      for (int64_t byte = trans.label; byte <= trans.hi; ++byte) {
+        const uint64_t cls = classes[byte];
+        assert((table[row + cls] == Dead || table[row + cls] == trans.to + 1) &&
+               "FSA is not deterministic");
+
+        table[row + cls] = trans.to + 1;
+      }
+    }
+
+    if (fsa.IsAcceptState(state))
+      accept_states[(state + 1) / 64] |= uint64_t{1} << ((state + 1) % 64);
+
+    const std::set<uint64_t> &state_tags = fsa.AcceptTags(state);
+    tags.insert(tags.end(), state_tags.begin(), state_tags.end());
+    tag_offsets.push_back(tags.size());
+  }
+}
+
+uint32_t DFA::Run(std::span<const uint8_t> input) const {
+  uint32_t state = start_state;
+  const uint64_t stride = classes.NumClasses();
+
+  for (uint8_t byte : input) {
+    state = table[state * stride + classes[byte]];
+
+    if (state == Dead)
+      return Dead;
+  }
+
+  return state;
+}
+
+uint32_t DFA::Run(std::span<const uint8_t> input, MatchTrace &trace) const {
+  uint32_t state = start_state;
+  const uint64_t stride = classes.NumClasses();
+
+  for (uint64_t i = 0; i < input.size(); ++i) {
+    state = table[state * stride + classes[input[i]]];
+
+    if (state == Dead) {
+      trace = {i + 1, true};
+      return Dead;
+    }
+  }
+
+  trace = {input.size(), false};
+  return state;
+}
+
+bool DFA::Match(std::span<const uint8_t> input) const {
+  return IsAcceptState(Run(input));
+}
+
+bool DFA::Match(std::string_view input) const {
+  return Match(std::span<const uint8_t>(
+      reinterpret_cast<const uint8_t *>(input.data()), input.size()));
+}
+
+namespace {
+
+// Inputs walked at once by MatchBatch. Enough to cover a cache miss's latency
+// with other walks' loads without running out of registers
+constexpr uint64_t BatchLanes{8};
+
+uint64_t Align(uint64_t offset) { return (offset + 7) / 8 * 8; }
+
+template <typename T>
+void Write(std::ostream &out, const T *data, uint64_t count) {
+  out.write(reinterpret_cast<const char *>(data), count * sizeof(T));
+  const uint64_t size = count * sizeof(T);
+  static constexpr char padding[8]{};
+  out.write(padding, Align(size) - size);
+}
+
+} // namespace
+
+/*
+ * Each lane holds one input. All lanes take as many steps together as the
+ * shortest remaining input allows, with no per-byte checks, then finished
+ * lanes are retired and refilled from the inputs not started yet.
+ */
+void DFA::MatchBatch(std::span<const std::string_view> inputs,
+                     std::span<bool> results) const {
+  assert(results.size() >= inputs.size());
+
+  struct Lane {
+    const uint8_t *pos;
+    const uint8_t *end;
+    uint32_t state;
+    uint64_t index;
+  };
+
+  std::array<Lane, BatchLanes> lanes;
+  uint64_t active = 0;
+  uint64_t next = 0;
+  const uint64_t stride = classes.NumClasses();
+
+  auto refill = [&](uint64_t lane) {
+    while (next < inputs.size()) {
+      const std::string_view input = inputs[next];
+      if (input.empty()) {
+        results[next++] = IsAcceptState(start_state);
+        continue;
+      }
+
+      const auto *data = reinterpret_cast<const uint8_t *>(input.data());
+      lanes[lane] = {data, data + input.size(), start_state, next++};
+      return true;
+    }
+    return false;
+  };
+
+  while (active < BatchLanes && refill(active))
+    ++active;
+
+  while (active > 0) {
+    uint64_t steps = lanes[0].end - lanes[0].pos;
+    for (uint64_t lane = 1; lane < active; ++lane)
+      steps = std::min<uint64_t>(steps, lanes[lane].end - lanes[lane].pos);
+
+    for (uint64_t step = 0; step < steps; ++step) {
+      for (uint64_t lane = 0; lane < active; ++lane) {
+        Lane &l = lanes[lane];
+        l.state = table[l.state * stride + classes[*l.pos++]];
+      }
+    }
+
+    for (uint64_t lane = 0; lane < active;) {
+      Lane &l = lanes[lane];
+      if (l.pos != l.end && l.state != Dead) {
+        ++lane;
+        continue;
+      }
+
+      results[l.index] = IsAcceptState(l.state);
+      if (!refill(lane))
+        lanes[lane] = lanes[--active];
+    }
+  }
+}
+
+void DFA::Serialize(std::ostream &out) const {
+  DFAFileHeader header{};
+  std::memcpy(header.magic, DFAFileHeader::Magic, sizeof(header.magic));
+  header.version = DFAFileHeader::Version;
+  header.byte_order = DFAFileHeader::ByteOrder;
+  header.start_state = start_state;
+  header.num_classes = classes.NumClasses();
+  header.num_states = NumStates();
+
+  header.classes_offset = Align(sizeof(DFAFileHeader));
+  header.table_offset = header.classes_offset + Align(AlphabetSize);
+  header.accept_offset =
+      header.table_offset + Align(table.size() * sizeof(uint32_t));
+  header.tag_offsets_offset =
+      header.accept_offset + accept_states.size() * sizeof(uint64_t);
+  header.tags_offset =
+      header.tag_offsets_offset + tag_offsets.size() * sizeof(uint64_t);
+  header.size = header.tags_offset + tags.size() * sizeof(uint64_t);
+
+  uint8_t class_map[AlphabetSize];
+  for (uint64_t byte = 0; byte < AlphabetSize; ++byte)
+    class_map[byte] = classes[byte];
+
+  Write(out, &header, 1);
+  Write(out, class_map, AlphabetSize);
+  Write(out, table.data(), table.size());
+  Write(out, accept_states.data(), accept_states.size());
+  Write(out, tag_offsets.data(), tag_offsets.size());
+  Write(out, tags.data(), tags.size());
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "ByteClasses.hpp"
+#include "FSA.hpp"
+#include "Stats.hpp"
+
+/*
+ * Compiled, frozen form of a deterministic FSA. Transitions live in a single
+ * row-major table indexed by [state][byte class] and the accept states in a
+ * bitmap, so consuming a byte is two indexed loads with no searching,
+ * recursion or allocation. Rows are only as wide as the number of byte
+ * classes the FSA distinguishes, see ByteClasses. State 0 is a dead state:
+ * every byte the FSA has no transition for leads there and it never leaves.
+ * The FSA's states are shifted up by one to make room for it.
+ */
+class DFA {
+public:
+  static constexpr uint32_t Dead{0};
+  static constexpr uint64_t AlphabetSize{256};
+
+private:
+  uint32_t start_state{Dead};
+  ByteClasses classes{};
+  std::vector<uint32_t> table{};
+  std::vector<uint64_t> accept_states{};
+  // Accept tags of state s are tags[tag_offsets[s]..tag_offsets[s + 1]]
+  std::vector<uint64_t> tag_offsets{};
+  std::vector<uint64_t> tags{};
+
+public:
+  // A DFA with only the dead state, which matches nothing
+  DFA();
+
+  // Freeze a deterministic FSA. The FSA must have been determinized and may
+  // only use labels in [0, AlphabetSize)
+  explicit DFA(const FSA &fsa);
+
+  uint32_t StartState() const { return start_state; }
+
+  uint64_t NumStates() const { return table.size() / classes.NumClasses(); }
+
+  const ByteClasses &Classes() const { return classes; }
+
+  uint32_t Next(uint32_t state, uint8_t byte) const {
+    return table[state * classes.NumClasses() + classes[byte]];
+  }
+
+  bool IsAcceptState(uint32_t state) const {
+    return (accept_states[state / 64] >> (state % 64)) & 1;
+  }
+
+  std::span<const uint64_t> AcceptTags(uint32_t state) const {
+    return {tags.data() + tag_offsets[state],
+            tags.data() + tag_offsets[state + 1]};
+  }
+
+  // Bytes taken up by the table, accept states and tags
+  uint64_t MemoryUsage() const {
+    return table.size() * sizeof(uint32_t) +
+           (accept_states.size() + tag_offsets.size() + tags.size()) *
+               sizeof(uint64_t);
+  }
+
+  // State reached after consuming input, Dead as soon as it dies
+  uint32_t Run(std::span<const uint8_t> input) const;
+
+  // Run, also noting how many bytes were consumed and whether it died
+  uint32_t Run(std::span<const uint8_t> input, MatchTrace &trace) const;
+
+  bool Match(std::span<const uint8_t> input) const;
+
+  bool Match(std::string_view input) const;
+
+  /*
+   * Match every input, storing the results in the same order. Several inputs
+   * are walked in lockstep so that their table loads overlap instead of each
+   * waiting on the last
+   */
+  void MatchBatch(std::span<const std::string_view> inputs,
+                  std::span<bool> results) const;
+
+  // Write the DFA in the format DFAView reads, see DFAFile.hpp
+  void Serialize(std::ostream &out) const;
+};
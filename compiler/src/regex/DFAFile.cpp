@@ -0,0 +1,144 @@
+#include "DFAFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Section of count elements of T at offset, checked against the buffer
+template <typename T>
+const T *Section(std::span<const std::byte> buffer, uint64_t offset,
+                 uint64_t count) {
+  if (offset % alignof(T) != 0 || offset > buffer.size() ||
+      count > (buffer.size() - offset) / sizeof(T))
+    throw DFAFileError{};
+
+  return reinterpret_cast<const T *>(buffer.data() + offset);
+}
+
+} // namespace
+
+DFAView::DFAView(std::span<const std::byte> buffer) {
+  if (buffer.size() < sizeof(DFAFileHeader) ||
+      reinterpret_cast<uintptr_t>(buffer.data()) % alignof(DFAFileHeader) != 0)
+    throw DFAFileError{};
+
+  const auto &header = *reinterpret_cast<const DFAFileHeader *>(buffer.data());
+
+  if (std::memcmp(header.magic, DFAFileHeader::Magic, sizeof(header.magic)) !=
+          0 ||
+      header.version != DFAFileHeader::Version ||
+      header.byte_order != DFAFileHeader::ByteOrder ||
+      header.size != buffer.size())
+    throw DFAFileError{};
+
+  num_states = header.num_states;
+  num_classes = header.num_classes;
+  start_state = header.start_state;
+
+  // The dead state is always there
+  if (num_states == 0 || num_states > UINT32_MAX || num_classes == 0 ||
+      num_classes > 256 || start_state >= num_states)
+    throw DFAFileError{};
+
+  classes = Section<uint8_t>(buffer, header.classes_offset, 256);
+  table = Section<uint32_t>(buffer, header.table_offset,
+                            num_states * num_classes);
+  accept_states = Section<uint64_t>(buffer, header.accept_offset,
+                                    (num_states + 63) / 64);
+  tag_offsets =
+      Section<uint64_t>(buffer, header.tag_offsets_offset, num_states + 1);
+  tags = Section<uint64_t>(buffer, header.tags_offset,
+                           tag_offsets[num_states]);
+
+  for (uint64_t byte = 0; byte < 256; ++byte) {
+    if (classes[byte] >= num_classes)
+      throw DFAFileError{};
+  }
+
+  for (uint64_t i = 0; i < num_states * num_classes; ++i) {
+    if (table[i] >= num_states)
+      throw DFAFileError{};
+  }
+
+  for (uint64_t state = 0; state < num_states; ++state) {
+    if (tag_offsets[state] > tag_offsets[state + 1])
+      throw DFAFileError{};
+  }
+}
+
+uint32_t DFAView::Run(std::span<const uint8_t> input) const {
+  uint32_t state = start_state;
+
+  for (uint8_t byte : input) {
+    state = table[state * num_classes + classes[byte]];
+
+    if (state == Dead)
+      return Dead;
+  }
+
+  return state;
+}
+
+bool DFAView::Match(std::span<const uint8_t> input) const {
+  return IsAcceptState(Run(input));
+}
+
+bool DFAView::Match(std::string_view input) const {
+  return Match(std::span<const uint8_t>(
+      reinterpret_cast<const uint8_t *>(input.data()), input.size()));
+}
+
+MappedFile::MappedFile(const std::string &path) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    throw DFAFileError{};
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+    close(fd);
+    throw DFAFileError{};
+  }
+
+  void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps the file alive on its own
+  close(fd);
+
+  if (mapped == MAP_FAILED)
+    throw DFAFileError{};
+
+  data = static_cast<const std::byte *>(mapped);
+  size = info.st_size;
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data(std::exchange(other.data, nullptr)),
+      size(std::exchange(other.size, 0)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    Release();
+    data = std::exchange(other.data, nullptr);
+    size = std::exchange(other.size, 0);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() { Release(); }
+
+void MappedFile::Release() {
+  if (data)
+    munmap(const_cast<std::byte *>(data), size);
+  data = nullptr;
+  size = 0;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+/*
+ * On-disk form of a DFA, laid out so that it can be mapped read-only and
+ * matched against where it lies. The file is a fixed header followed by
+ * sections, each found through an offset from the start of the file and
+ * aligned to 8 bytes, so nothing in it depends on where it is mapped:
+ *
+ *   classes      256 x uint8_t, byte to class
+ *   table        num_states * num_classes x uint32_t, [state][class]
+ *   accept       (num_states + 63) / 64 x uint64_t bitmap
+ *   tag_offsets  num_states + 1 x uint64_t
+ *   tags         tag_offsets[num_states] x uint64_t
+ *
+ * Integers are in the byte order of the machine that wrote the file; the
+ * byte_order field catches files moved across.
+ */
+struct DFAFileHeader {
+  static constexpr char Magic[8]{'R', 'E', 'G', 'E', 'X', 'D', 'F', 'A'};
+  static constexpr uint32_t Version{1};
+  static constexpr uint32_t ByteOrder{0x01020304};
+
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t start_state;
+  uint32_t num_classes;
+  uint64_t num_states;
+  uint64_t size;
+  uint64_t classes_offset;
+  uint64_t table_offset;
+  uint64_t accept_offset;
+  uint64_t tag_offsets_offset;
+  uint64_t tags_offset;
+};
+
+// Thrown for files that can't be read or aren't a valid compiled DFA
+struct DFAFileError {};
+
+/*
+ * Read-only DFA over a buffer in the format above, typically a MappedFile.
+ * Nothing is copied; the buffer must outlive the view. The constructor checks
+ * the header and walks the table once so that a corrupt file can't make
+ * matching read out of bounds.
+ */
+class DFAView {
+public:
+  static constexpr uint32_t Dead{0};
+
+private:
+  uint32_t start_state{Dead};
+  uint64_t num_states{0};
+  uint64_t num_classes{0};
+  const uint8_t *classes{nullptr};
+  const uint32_t *table{nullptr};
+  const uint64_t *accept_states{nullptr};
+  const uint64_t *tag_offsets{nullptr};
+  const uint64_t *tags{nullptr};
+
+public:
+  /*
+   * Ctor. May throw a DFAFileError
+   */
+  explicit DFAView(std::span<const std::byte> buffer);
+
+  uint32_t StartState() const { return start_state; }
+
+  uint64_t NumStates() const { return num_states; }
+
+  uint32_t Next(uint32_t state, uint8_t byte) const {
+    return table[state * num_classes + classes[byte]];
+  }
+
+  bool IsAcceptState(uint32_t state) const {
+    return (accept_states[state / 64] >> (state % 64)) & 1;
+  }
+
+  std::span<const uint64_t> AcceptTags(uint32_t state) const {
+    return {tags + tag_offsets[state], tags + tag_offsets[state + 1]};
+  }
+
+  // State reached after consuming input, Dead as soon as it dies
+  uint32_t Run(std::span<const uint8_t> input) const;
+
+  bool Match(std::span<const uint8_t> input) const;
+
+  bool Match(std::string_view input) const;
+};
+
+/*
+ * Whole file mapped read-only and shared, so every process mapping the same
+ * file shares its pages. Move only.
+ */
+class MappedFile {
+private:
+  const std::byte *data{nullptr};
+  size_t size{0};
+
+  // Unmaps the file, if any, leaving this empty
+  void Release();
+
+public:
+  /*
+   * Ctor. May throw a DFAFileError
+   */
+  explicit MappedFile(const std::string &path);
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  ~MappedFile();
+
+  std::span<const std::byte> Bytes() const { return {data, size}; }
+};
@@ -4,10 +4,25 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
-#include <queue>
+#include <limits>
+#include <map>
 #include <set>
+#include <span>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+namespace {
+
+// Bytes a vector has reserved
+template <typename T> uint64_t Reserved(const std::vector<T> &vec) {
+  return vec.capacity() * sizeof(T);
+}
+
+uint64_t Reserved(const std::vector<bool> &vec) { return vec.capacity() / 8; }
+
+} // namespace
+
 void FSA::AddStates(uint64_t how_many) {
   transitions.resize(transitions.size() + how_many);
 }
@@ -19,23 +34,41 @@ void FSA::AddTransition(uint64_t from, uint64_t to, int64_t label) {
   transitions[from].emplace_back(label, to);
 }
 
+void FSA::AddTransition(uint64_t from, uint64_t to, int64_t lo, int64_t hi) {
+  assert(from < transitions.size());
+  assert(to < transitions.size());
+  assert(lo <= hi && (lo >= 0 || lo == hi));
+
+  transitions[from].emplace_back(lo, to, hi);
+}
+
 void FSA::AcceptState(uint64_t state) {
   assert(state < transitions.size());
 
   accept_states.insert(state);
 }
 
+void FSA::TagAcceptStates(uint64_t tag) {
+  for (uint64_t state : accept_states)
+    accept_tags[state].insert(tag);
+}
+
+const std::set<uint64_t> &FSA::AcceptTags(uint64_t state) const {
+  static const std::set<uint64_t> none{};
+
+  auto tags = accept_tags.find(state);
+  return tags == accept_tags.end() ? none : tags->second;
+}
+
 void FSA::StartState(uint64_t state) {
   assert(state < transitions.size());
 
   start_state = state;
 }
 
-bool FSA::ConsumeRange(std::vector<int64_t>::const_iterator begin,
-                       std::vector<int64_t>::const_iterator end,
-                       uint64_t state) const {
+bool FSA::ConsumeRange(std::span<const int64_t> toks, uint64_t state) const {
 
-  if (begin == end) {
+  if (toks.empty()) {
     if (accept_states.count(state))
       return true;
 
@@ -45,11 +78,11 @@ bool FSA::ConsumeRange(std::vector<int64_t>::const_iterator begin,
   auto transition = transitions[state].begin();
 
   while ((transition = std::find_if(transition, transitions[state].end(),
-                                    [begin](const Transition &x) {
-                                      return x.label == *begin;
+                                    [&toks](const Transition &x) {
+                                      return x.Covers(toks.front());
                                     })) != transitions[state].end()) {
 
-    if (ConsumeRange(begin + 1, end, transition->to))
+    if (ConsumeRange(toks.subspan(1), transition->to))
       return true;
 
     ++transition;
@@ -58,18 +91,18 @@ bool FSA::ConsumeRange(std::vector<int64_t>::const_iterator begin,
   return false;
 }
 
-bool FSA::ConsumeString(std::vector<int64_t> toks) const {
+bool FSA::ConsumeString(std::span<const int64_t> toks) const {
   uint64_t state = start_state;
 
   if (transitions.empty())
     return false;
 
-  return ConsumeRange(toks.begin(), toks.end(), state);
+  return ConsumeRange(toks, state);
 
   for (int64_t tok : toks) {
     auto transition =
         std::find_if(transitions[state].begin(), transitions[state].end(),
-                     [tok](const Transition &x) { return x.label == tok; });
+                     [tok](const Transition &x) { return x.Covers(tok); });
 
     if (transition == transitions[state].end())
       return false;
@@ -84,95 +117,546 @@ bool FSA::ConsumeString(std::vector<int64_t> toks) const {
 }
 
 /*
- * Just using naive algorithm rather than offline one for now
+ * Tarjan's algorithm over the epsilon edges. Components are completed in
+ * reverse topological order, so by the time a component is popped the
+ * closures of everything it reaches are already in the arena and its own
+ * closure is just their union plus its members. Only states that consume input
+ * or accept are recorded, which is all subset construction needs.
  */
-std::set<uint64_t> FSA::EpsilonClosure(uint64_t state) const {
-  assert(state < transitions.size());
+FSA::Closures FSA::EpsilonClosures() const {
+  constexpr uint64_t unvisited = std::numeric_limits<uint64_t>::max();
+  const uint64_t n_states = transitions.size();
+
+  Closures res;
+  res.component.assign(n_states, unvisited);
+
+  std::vector<uint64_t> index(n_states, unvisited);
+  std::vector<uint64_t> lowlink(n_states);
+  std::vector<uint64_t> stack;
+  // (state, next transition to look at) for the explicit DFS
+  std::vector<std::pair<uint64_t, uint64_t>> call;
+
+  // States that only have epsilon transitions out and don't accept never
+  // change the outcome of a subset, so they're left out of the closures
+  auto important = [this](uint64_t state) {
+    if (accept_states.contains(state))
+      return true;
+    return std::any_of(
+        transitions[state].begin(), transitions[state].end(),
+        [](const Transition &trans) { return !IsEpsilon(trans.label); });
+  };
 
-  std::set<uint64_t> res{};
+  // Last component each state was added for, to dedupe without a set
+  std::vector<uint64_t> seen(n_states, unvisited);
+  uint64_t next_index{0};
 
-  std::queue<uint64_t> work{};
-  work.push(state);
+  auto visit = [&](uint64_t state) {
+    index[state] = lowlink[state] = next_index++;
+    stack.push_back(state);
+    call.emplace_back(state, 0);
+  };
 
-  while (!work.empty()) {
-    uint64_t curr_state = work.front();
-    work.pop();
+  for (uint64_t root = 0; root < n_states; ++root) {
+    if (index[root] != unvisited)
+      continue;
+
+    visit(root);
+
+    while (!call.empty()) {
+      const uint64_t state = call.back().first;
+      uint64_t &edge = call.back().second;
 
-    res.insert(curr_state);
+      while (edge < transitions[state].size() &&
+             !IsEpsilon(transitions[state][edge].label))
+        ++edge;
 
-    for (const Transition &trans : transitions[curr_state]) {
-      if (trans.label == Eps && !res.contains(trans.to))
-        work.push(trans.to);
+      if (edge < transitions[state].size()) {
+        const uint64_t to = transitions[state][edge++].to;
+
+        if (index[to] == unvisited)
+          visit(to);
+        else if (res.component[to] == unvisited)
+          lowlink[state] = std::min(lowlink[state], index[to]);
+
+        continue;
+      }
+
+      call.pop_back();
+      if (!call.empty()) {
+        const uint64_t parent = call.back().first;
+        lowlink[parent] = std::min(lowlink[parent], lowlink[state]);
+      }
+
+      if (lowlink[state] != index[state])
+        continue;
+
+      const uint64_t component = res.offsets.size() - 1;
+      const uint64_t begin = res.arena.size();
+
+      auto add = [&](uint64_t member) {
+        if (seen[member] != component) {
+          seen[member] = component;
+          res.arena.push_back(member);
+        }
+      };
+
+      const auto members_begin =
+          std::find(stack.rbegin(), stack.rend(), state).base() - 1;
+      for (auto it = members_begin; it != stack.end(); ++it) {
+        res.component[*it] = component;
+        if (important(*it))
+          add(*it);
+      }
+
+      for (auto it = members_begin; it != stack.end(); ++it) {
+        for (const Transition &trans : transitions[*it]) {
+          if (!IsEpsilon(trans.label) || res.component[trans.to] == component)
+            continue;
+
+          const uint64_t succ = res.component[trans.to];
+          for (uint64_t i = res.offsets[succ]; i < res.offsets[succ + 1]; ++i)
+            add(res.arena[i]);
+        }
+      }
+
+      stack.erase(members_begin, stack.end());
+      std::sort(res.arena.begin() + begin, res.arena.end());
+      res.offsets.push_back(res.arena.size());
     }
   }
 
   return res;
 }
 
+size_t FSA::StateSetHash::operator()(
+    const std::vector<uint64_t> &states) const {
+  uint64_t hash{0xcbf29ce484222325};
+  for (uint64_t state : states) {
+    hash ^= state;
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
 /*
- *
+ * Subset construction. Each DFA state is the sorted set of NFA states it
+ * stands for, and a hash map from that set to the DFA state finds existing
+ * states in expected constant time, so the work is proportional to the size of
+ * the output. The ranges of the moves out of a subset are cut into disjoint
+ * intervals so every label gets exactly one target subset.
  */
-void FSA::Determinize() {
+void FSA::Determinize(CompileStats *stats) {
   if (transitions.size() == 0)
     return;
 
-  std::vector<std::set<uint64_t>> new_states;
-  std::vector<std::vector<Transition>> new_transitions;
+  uint64_t *closures_ns{nullptr};
+  uint64_t *subsets_ns{nullptr};
+  if constexpr (StatsEnabled) {
+    if (stats) {
+      closures_ns = &stats->closures_ns;
+      subsets_ns = &stats->subsets_ns;
+    }
+  }
 
-  new_states.push_back(EpsilonClosure(start_state));
-  new_transitions.resize(1);
+  using StateSet = std::vector<uint64_t>;
 
-  std::queue<uint64_t> to_handle;
-  to_handle.push(0);
+  std::unordered_map<StateSet, uint64_t, StateSetHash> ids;
+  // Points into the keys of ids, which are stable across rehashing
+  std::vector<const StateSet *> new_states;
+  std::vector<std::vector<Transition>> new_transitions;
 
-  while (!to_handle.empty()) {
-    uint64_t curr_state = to_handle.front();
-    std::set<uint64_t> curr = new_states[curr_state];
-    to_handle.pop();
+  auto add_state = [&](StateSet &&states) -> uint64_t {
+    auto [it, inserted] = ids.try_emplace(std::move(states), new_states.size());
+    if (inserted) {
+      new_states.push_back(&it->first);
+      new_transitions.emplace_back();
+    }
+    return it->second;
+  };
 
-    for (uint64_t src_state : curr) {
-      for (const Transition &src_transition : transitions[src_state]) {
-        if (src_transition.label == Eps)
-          continue;
+  const Closures closures = [&] {
+    StatsTimer timer(closures_ns);
+    return EpsilonClosures();
+  }();
 
-        std::set<uint64_t> trans_closure = EpsilonClosure(src_transition.to);
+  StatsTimer timer(subsets_ns);
+  uint64_t n_closures{0};
 
-        uint64_t found_state{0};
-        for (; found_state < new_states.size(); ++found_state) {
-          if (std::includes(new_states[found_state].begin(),
-                            new_states[found_state].end(),
-                            trans_closure.begin(), trans_closure.end()))
-            break;
-        }
+  {
+    std::span<const uint64_t> start = closures[start_state];
+    add_state(StateSet(start.begin(), start.end()));
+  }
 
-        if (found_state == new_states.size()) {
-          new_states.push_back(trans_closure);
-          new_transitions.resize(new_transitions.size() + 1);
-          new_transitions[curr_state].emplace_back(src_transition.label,
-                                                   new_states.size() - 1);
+  std::vector<Transition> moves;
+  std::vector<int64_t> bounds;
+  std::vector<const Transition *> active;
+  StateSet target;
+  // Stamp of the last subset each NFA state was added to
+  constexpr uint64_t unvisited = std::numeric_limits<uint64_t>::max();
+  std::vector<uint64_t> seen(transitions.size(), unvisited);
+  uint64_t stamp{0};
+
+  // New states are appended as they are found, so walking the ids in order
+  // visits each one exactly once
+  for (uint64_t curr_state = 0; curr_state < new_states.size(); ++curr_state) {
+    moves.clear();
+    for (uint64_t src_state : *new_states[curr_state]) {
+      for (const Transition &src_transition : transitions[src_state]) {
+        if (!IsEpsilon(src_transition.label))
+          moves.push_back(src_transition);
+      }
+    }
 
-          to_handle.push(new_states.size() - 1);
-        } else {
-          new_transitions[curr_state].emplace_back(src_transition.label,
-                                                   found_state);
+    std::sort(moves.begin(), moves.end(),
+              [](const Transition &a, const Transition &b) {
+                return a.label < b.label;
+              });
+
+    // The ends of every move's range cut the labels into intervals that each
+    // move either covers entirely or not at all
+    bounds.clear();
+    for (const Transition &move : moves) {
+      bounds.push_back(move.label);
+      bounds.push_back(move.hi + 1);
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    active.clear();
+    auto next = moves.begin();
+    for (uint64_t b = 0; b + 1 < bounds.size(); ++b) {
+      const int64_t lo = bounds[b];
+      const int64_t hi = bounds[b + 1] - 1;
+
+      std::erase_if(active, [lo](const Transition *move) {
+        return move->hi < lo;
+      });
+      for (; next != moves.end() && next->label == lo; ++next)
+        active.push_back(&*next);
+
+      if (active.empty())
+        continue;
+
+      target.clear();
+      n_closures += active.size();
+      for (const Transition *move : active) {
+        for (uint64_t state : closures[move->to]) {
+          if (seen[state] != stamp) {
+            seen[state] = stamp;
+            target.push_back(state);
+          }
         }
       }
+      ++stamp;
+      std::sort(target.begin(), target.end());
+
+      const uint64_t to = add_state(StateSet(target));
+
+      // Neighbouring intervals that lead to the same subset share one arc
+      std::vector<Transition> &out = new_transitions[curr_state];
+      if (!out.empty() && out.back().to == to && out.back().hi + 1 == lo)
+        out.back().hi = hi;
+      else
+        out.emplace_back(lo, to, hi);
     }
   }
 
-  transitions = new_transitions;
-  start_state = 0;
+  // Nothing is freed before this point, so every structure is at its largest
+  if constexpr (StatsEnabled) {
+    if (stats) {
+      uint64_t bytes = Reserved(closures.arena) + Reserved(closures.offsets) +
+                       Reserved(closures.component);
+      // A node per subset holding its key, id, cached hash and next pointer
+      bytes += ids.bucket_count() * sizeof(void *) +
+               ids.size() * (sizeof(*ids.begin()) + 2 * sizeof(void *));
+      for (const StateSet *subset : new_states)
+        bytes += Reserved(*subset);
+      bytes += Reserved(new_states) + Reserved(new_transitions);
+      for (const std::vector<Transition> &out : new_transitions)
+        bytes += Reserved(out);
+      bytes += Reserved(moves) + Reserved(bounds) + Reserved(active) +
+               Reserved(target) + Reserved(seen);
+
+      stats->determinize_peak_bytes =
+          std::max(stats->determinize_peak_bytes, bytes);
+    }
+  }
 
   std::set<uint64_t> new_accept_states;
+  std::map<uint64_t, std::set<uint64_t>> new_accept_tags;
 
   for (uint64_t i = 0; i < new_states.size(); ++i) {
-    for (uint64_t src_state : new_states[i]) {
-      if (accept_states.contains(src_state))
-        new_accept_states.insert(i);
+    for (uint64_t src_state : *new_states[i]) {
+      if (!accept_states.contains(src_state))
+        continue;
+
+      new_accept_states.insert(i);
+
+      auto tags = accept_tags.find(src_state);
+      if (tags != accept_tags.end())
+        new_accept_tags[i].insert(tags->second.begin(), tags->second.end());
+    }
+  }
+
+  transitions = std::move(new_transitions);
+  start_state = 0;
+  accept_states = std::move(new_accept_states);
+  accept_tags = std::move(new_accept_tags);
+
+  if constexpr (StatsEnabled) {
+    if (stats)
+      stats->epsilon_closures += n_closures;
+  }
+}
+
+/*
+ * Hopcroft's partition refinement. The FSA is completed with an explicit sink
+ * state so every state has a transition on every label, then the states are
+ * split, starting from {rejecting, accepting with each set of tags}, until no
+ * block has two members that disagree on which block some label leads to.
+ * Every block is a contiguous range of one permutation of the states, so
+ * moving a state between blocks is just a swap. Processing the smaller half of
+ * each split keeps this at O(n k log n) for n states and k labels.
+ */
+void FSA::Minimize(CompileStats *stats) {
+  if (transitions.empty())
+    return;
+
+  // Labels are the intervals between consecutive bounds, cut so that every
+  // transition covers a run of whole intervals
+  std::vector<int64_t> bounds;
+  for (const auto &src : transitions) {
+    for (const Transition &trans : src) {
+      assert(!IsEpsilon(trans.label));
+      bounds.push_back(trans.label);
+      bounds.push_back(trans.hi + 1);
+    }
+  }
+  std::sort(bounds.begin(), bounds.end());
+  bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+  const uint64_t n_labels = bounds.empty() ? 0 : bounds.size() - 1;
+  const uint64_t sink = transitions.size();
+  const uint64_t n_states = transitions.size() + 1;
+
+  // Complete transition function, row per state
+  std::vector<uint64_t> delta(n_states * n_labels, sink);
+  for (uint64_t state = 0; state < transitions.size(); ++state) {
+    for (const Transition &trans : transitions[state]) {
+      auto first = std::lower_bound(bounds.begin(), bounds.end(), trans.label);
+      auto last = std::lower_bound(first, bounds.end(), trans.hi + 1);
+      for (uint64_t label = first - bounds.begin();
+           label < static_cast<uint64_t>(last - bounds.begin()); ++label) {
+        assert(delta[state * n_labels + label] == sink);
+        delta[state * n_labels + label] = trans.to;
+      }
     }
   }
 
+  // Predecessors indexed by (target, label) in CSR form
+  std::vector<uint64_t> pred_offsets(n_states * n_labels + 1, 0);
+  for (uint64_t i = 0; i < delta.size(); ++i)
+    ++pred_offsets[delta[i] * n_labels + i % n_labels + 1];
+  for (uint64_t i = 1; i < pred_offsets.size(); ++i)
+    pred_offsets[i] += pred_offsets[i - 1];
+
+  std::vector<uint64_t> preds(delta.size());
+  {
+    std::vector<uint64_t> fill(pred_offsets.begin(), pred_offsets.end() - 1);
+    for (uint64_t i = 0; i < delta.size(); ++i)
+      preds[fill[delta[i] * n_labels + i % n_labels]++] = i / n_labels;
+  }
+
+  // Blocks are [block_begin, block_end) ranges of elems
+  std::vector<uint64_t> elems(n_states);
+  std::vector<uint64_t> location(n_states);
+  std::vector<uint64_t> block_of(n_states);
+  std::vector<uint64_t> block_begin;
+  std::vector<uint64_t> block_end;
+
+  // Initial blocks group states that accept the same way: rejecting, or
+  // accepting with a particular set of tags
+  {
+    std::map<std::pair<bool, std::set<uint64_t>>, std::vector<uint64_t>>
+        initial;
+    for (uint64_t state = 0; state < n_states; ++state)
+      initial[{accept_states.contains(state), AcceptTags(state)}].push_back(
+          state);
+
+    uint64_t i{0};
+    for (const auto &[key, members] : initial) {
+      block_begin.push_back(i);
+      for (uint64_t state : members)
+        elems[i++] = state;
+      block_end.push_back(i);
+    }
+  }
+
+  for (uint64_t block = 0; block < block_begin.size(); ++block) {
+    for (uint64_t i = block_begin[block]; i < block_end[block]; ++i) {
+      location[elems[i]] = i;
+      block_of[elems[i]] = block;
+    }
+  }
+
+  std::vector<std::pair<uint64_t, uint64_t>> work;
+  std::vector<bool> in_work(n_states * n_labels, false);
+
+  auto push_work = [&](uint64_t block, uint64_t label) {
+    work.emplace_back(block, label);
+    in_work[block * n_labels + label] = true;
+  };
+
+  // Every initial block but the largest is a splitter
+  {
+    uint64_t largest{0};
+    for (uint64_t block = 1; block < block_begin.size(); ++block) {
+      if (block_end[block] - block_begin[block] >
+          block_end[largest] - block_begin[largest])
+        largest = block;
+    }
+
+    for (uint64_t block = 0; block < block_begin.size(); ++block) {
+      if (block == largest)
+        continue;
+      for (uint64_t label = 0; label < n_labels; ++label)
+        push_work(block, label);
+    }
+  }
+
+  std::vector<uint64_t> marked(n_states, 0);
+  std::vector<uint64_t> touched;
+  std::vector<uint64_t> splitter;
+
+  while (!work.empty()) {
+    auto [block, label] = work.back();
+    work.pop_back();
+    in_work[block * n_labels + label] = false;
+
+    splitter.assign(elems.begin() + block_begin[block],
+                    elems.begin() + block_end[block]);
+
+    // Move every state with a transition into the splitter to the front of
+    // its block
+    for (uint64_t state : splitter) {
+      const uint64_t key = state * n_labels + label;
+      for (uint64_t i = pred_offsets[key]; i < pred_offsets[key + 1]; ++i) {
+        const uint64_t pred = preds[i];
+        const uint64_t pred_block = block_of[pred];
+        const uint64_t boundary = block_begin[pred_block] + marked[pred_block];
+
+        if (location[pred] < boundary)
+          continue;
+
+        if (marked[pred_block] == 0)
+          touched.push_back(pred_block);
+
+        const uint64_t displaced = elems[boundary];
+        std::swap(elems[location[pred]], elems[boundary]);
+        location[displaced] = location[pred];
+        location[pred] = boundary;
+        ++marked[pred_block];
+      }
+    }
+
+    for (uint64_t split : touched) {
+      const uint64_t n_marked = marked[split];
+      marked[split] = 0;
+
+      if (n_marked == block_end[split] - block_begin[split])
+        continue;
+
+      // The marked prefix becomes a new block
+      const uint64_t new_block = block_begin.size();
+      block_begin.push_back(block_begin[split]);
+      block_end.push_back(block_begin[split] + n_marked);
+      block_begin[split] += n_marked;
+
+      for (uint64_t i = block_begin[new_block]; i < block_end[new_block]; ++i)
+        block_of[elems[i]] = new_block;
+
+      const bool new_smaller =
+          n_marked <= block_end[split] - block_begin[split];
+      for (uint64_t l = 0; l < n_labels; ++l) {
+        if (in_work[split * n_labels + l] || new_smaller)
+          push_work(new_block, l);
+        else
+          push_work(split, l);
+      }
+    }
+    touched.clear();
+  }
+
+  // Rebuild from the start state's block, skipping the sink's block, which
+  // also drops every unreachable and dead state
+  const uint64_t sink_block = block_of[sink];
+  constexpr uint64_t unvisited = std::numeric_limits<uint64_t>::max();
+  std::vector<uint64_t> new_id(block_begin.size(), unvisited);
+  std::vector<uint64_t> order;
+
+  new_id[block_of[start_state]] = 0;
+  order.push_back(block_of[start_state]);
+
+  std::vector<std::vector<Transition>> new_transitions;
+  std::set<uint64_t> new_accept_states;
+  std::map<uint64_t, std::set<uint64_t>> new_accept_tags;
+
+  for (uint64_t i = 0; i < order.size(); ++i) {
+    const uint64_t block = order[i];
+    const uint64_t rep = elems[block_begin[block]];
+
+    new_transitions.emplace_back();
+    if (accept_states.contains(rep))
+      new_accept_states.insert(i);
+
+    auto tags = accept_tags.find(rep);
+    if (tags != accept_tags.end())
+      new_accept_tags[i] = tags->second;
+
+    for (uint64_t label = 0; label < n_labels; ++label) {
+      const uint64_t target = block_of[delta[rep * n_labels + label]];
+      if (target == sink_block)
+        continue;
+
+      if (new_id[target] == unvisited) {
+        new_id[target] = order.size();
+        order.push_back(target);
+      }
+
+      const int64_t lo = bounds[label];
+      const int64_t hi = bounds[label + 1] - 1;
+      std::vector<Transition> &out = new_transitions[i];
+      if (!out.empty() && out.back().to == new_id[target] &&
+          out.back().hi + 1 == lo)
+        out.back().hi = hi;
+      else
+        out.emplace_back(lo, new_id[target], hi);
+    }
+  }
+
+  // Everything but the scoped initial grouping is still held here
+  if constexpr (StatsEnabled) {
+    if (stats) {
+      uint64_t bytes = Reserved(bounds) + Reserved(delta) +
+                       Reserved(pred_offsets) + Reserved(preds) +
+                       Reserved(elems) + Reserved(location) +
+                       Reserved(block_of) + Reserved(block_begin) +
+                       Reserved(block_end) + Reserved(work) +
+                       Reserved(in_work) + Reserved(marked) +
+                       Reserved(touched) + Reserved(splitter) +
+                       Reserved(new_id) + Reserved(order) +
+                       Reserved(new_transitions);
+      for (const std::vector<Transition> &out : new_transitions)
+        bytes += Reserved(out);
+
+      stats->minimize_peak_bytes = std::max(stats->minimize_peak_bytes, bytes);
+    }
+  }
+
+  transitions = new_transitions;
   accept_states = new_accept_states;
+  accept_tags = new_accept_tags;
+  start_state = 0;
 }
 
 /*
@@ -193,9 +677,9 @@ FSA FSA::Concatenate(const FSA &left, const FSA &right) {
 
   for (size_t i = 0; i < right.transitions.size(); ++i) {
     for (size_t j = 0; j < right.transitions[i].size(); ++j) {
-      res.AddTransition(i + left_n_states,
-                        right.transitions[i][j].to + left_n_states,
-                        right.transitions[i][j].label);
+      const Transition &trans = right.transitions[i][j];
+      res.AddTransition(i + left_n_states, trans.to + left_n_states,
+                        trans.label, trans.hi);
     }
   }
 
@@ -207,16 +691,22 @@ FSA FSA::Concatenate(const FSA &left, const FSA &right) {
   for (uint64_t accepted : right.accept_states)
     res.accept_states.insert(accepted + left_n_states);
 
+  res.accept_tags.clear();
+  for (const auto &[accepted, tags] : right.accept_tags)
+    res.accept_tags[accepted + left_n_states] = tags;
+
   return res;
 }
 
 /*/
  * Insert a new start state
  * Add a new final accept state
- * Add eps transitions from all accept states to new accept state
  * Add eps transitions from all accept states back to old start state
+ * Add eps transitions from all accept states to new accept state
  * Add transitions from new start to the old start and the final state
  *
+ * Transitions are added in order of preference, so that anything resolving
+ * ambiguities by transition order (tagged determinization) sees a greedy star
  */
 FSA FSA::Closure(const FSA &left) {
   FSA res{left};
@@ -230,43 +720,81 @@ FSA FSA::Closure(const FSA &left) {
   res.AddTransition(new_start, new_accept, FSA::Eps);
 
   for (uint64_t acc : res.accept_states) {
-    res.AddTransition(acc, new_accept, FSA::Eps);
     res.AddTransition(acc, res.start_state, FSA::Eps);
+    res.AddTransition(acc, new_accept, FSA::Eps);
   }
 
   res.accept_states = {new_accept};
   res.start_state = new_start;
 
+  std::set<uint64_t> tags;
+  for (const auto &[acc, acc_tags] : res.accept_tags)
+    tags.insert(acc_tags.begin(), acc_tags.end());
+  res.accept_tags.clear();
+  if (!tags.empty())
+    res.accept_tags[new_accept] = tags;
+
   return res;
 }
 
+/*
+ * Insert a new start state with eps transitions to the start states of both
+ * fsas. The accept states (and their tags) of both are kept as they are, so
+ * it stays possible to tell which side accepted.
+ */
 FSA FSA::Union(const FSA &left, const FSA &right) {
   FSA res{left};
-  res.AddStates(right.transitions.size() + 2);
+  const uint64_t left_n_states = left.transitions.size();
+
+  res.AddStates(right.transitions.size() + 1);
 
-  uint64_t new_accept{res.transitions.size() - 1};
-  uint64_t new_start{res.transitions.size() - 2};
+  uint64_t new_start{res.transitions.size() - 1};
 
   for (size_t i = 0; i < right.transitions.size(); ++i) {
     for (size_t j = 0; j < right.transitions[i].size(); ++j) {
-      res.AddTransition(i + left.transitions.size(),
-                        right.transitions[i][j].to + left.transitions.size(),
-                        right.transitions[i][j].label);
+      const Transition &trans = right.transitions[i][j];
+      res.AddTransition(i + left_n_states, trans.to + left_n_states,
+                        trans.label, trans.hi);
     }
   }
 
   res.AddTransition(new_start, left.start_state, FSA::Eps);
-  res.AddTransition(new_start, left.transitions.size() + right.start_state,
-                    FSA::Eps);
+  res.AddTransition(new_start, left_n_states + right.start_state, FSA::Eps);
   res.start_state = new_start;
 
-  res.accept_states = {new_accept};
+  for (uint64_t acc : right.accept_states)
+    res.accept_states.insert(left_n_states + acc);
 
-  for (uint64_t acc : left.accept_states)
-    res.AddTransition(acc, new_accept, FSA::Eps);
+  for (const auto &[acc, tags] : right.accept_tags)
+    res.accept_tags[left_n_states + acc] = tags;
 
-  for (uint64_t acc : right.accept_states)
-    res.AddTransition(left.transitions.size() + acc, new_accept, FSA::Eps);
+  return res;
+}
+
+/*
+ * Flip every transition, then add a new start state with eps transitions to
+ * all the old accept states. The old start state is the only accept state.
+ * Tags are dropped since there is no accept state left to carry them.
+ */
+FSA FSA::Reverse(const FSA &fsa) {
+  FSA res;
+
+  if (fsa.transitions.empty())
+    return res;
+
+  res.AddStates(fsa.transitions.size() + 1);
+  const uint64_t new_start = fsa.transitions.size();
+
+  for (uint64_t i = 0; i < fsa.transitions.size(); ++i) {
+    for (const Transition &trans : fsa.transitions[i])
+      res.AddTransition(trans.to, i, trans.label, trans.hi);
+  }
+
+  for (uint64_t acc : fsa.accept_states)
+    res.AddTransition(new_start, acc, FSA::Eps);
+
+  res.start_state = new_start;
+  res.accept_states = {fsa.start_state};
 
   return res;
 }
@@ -277,17 +805,43 @@ std::ostream &operator<<(std::ostream &os, const FSA &fsa) {
   for (uint64_t acc : fsa.accept_states)
     os << acc << " ";
   os << '\n';
+  if (!fsa.accept_tags.empty()) {
+    os << "accept tags: \n";
+    for (const auto &[acc, tags] : fsa.accept_tags) {
+      os << acc << ":";
+      for (uint64_t tag : tags)
+        os << " " << tag;
+      os << '\n';
+    }
+  }
   os << "transitions: \n";
   for (size_t i = 0; i < fsa.transitions.size(); ++i) {
     for (size_t j = 0; j < fsa.transitions[i].size(); ++j) {
-      os << i << " " << fsa.transitions[i][j].to << " "
-         << (fsa.transitions[i][j].label) << '\n';
+      const FSA::Transition &trans = fsa.transitions[i][j];
+      os << i << " " << trans.to << " " << trans.label;
+      if (trans.hi != trans.label)
+        os << "-" << trans.hi;
+      os << '\n';
     }
   }
 
   return os;
 };
 
+uint64_t FSA::NumTransitions() const {
+  uint64_t n{0};
+  for (const auto &src : transitions)
+    n += src.size();
+  return n;
+}
+
+uint64_t FSA::MemoryUsage() const {
+  uint64_t bytes = transitions.capacity() * sizeof(transitions[0]);
+  for (const auto &src : transitions)
+    bytes += src.capacity() * sizeof(Transition);
+  return bytes;
+}
+
 bool FSA::Empty() const {
   for (const auto &src : transitions) {
     if (!src.empty())
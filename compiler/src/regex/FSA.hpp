@@ -1,10 +1,16 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <iostream>
+#include <map>
 #include <set>
+#include <span>
 #include <vector>
 
+#include "Stats.hpp"
+
 /*
  * Simple FSA implementation with state set {0, ..., n_states - 1} and alphabet
  * {0, ..., n_alphabet - 1}. Negative labels are reserved for special tokens.
@@ -15,13 +21,71 @@
  */
 class FSA {
 public:
+  /*
+   * A transition on every label in [label, hi], so a character class like
+   * [a-z] is one arc rather than 26. Single labels, and all the special ones,
+   * have hi == label
+   */
   struct Transition {
     int64_t label;
     uint64_t to;
+    int64_t hi;
+
+    constexpr Transition(int64_t label, uint64_t to)
+        : label(label), to(to), hi(label) {}
+
+    constexpr Transition(int64_t label, uint64_t to, int64_t hi)
+        : label(label), to(to), hi(hi) {}
+
+    constexpr bool Covers(int64_t symbol) const {
+      return label <= symbol && symbol <= hi;
+    }
   };
 
   static constexpr int64_t Eps{-1};
 
+  /*
+   * Tags mark positions in the input, such as where a capture group opens or
+   * closes. Tag t is the label -2 - t. Like Eps, a tag consumes no input, so
+   * everything but tagged determinization treats the two the same
+   */
+  static constexpr int64_t Tag(uint64_t tag) {
+    return -2 - static_cast<int64_t>(tag);
+  }
+
+  static constexpr bool IsTag(int64_t label) { return label <= -2; }
+
+  static constexpr uint64_t TagOf(int64_t label) { return -2 - label; }
+
+  static constexpr bool IsEpsilon(int64_t label) { return label < 0; }
+
+  /*
+   * Epsilon closure of every state, computed once up front. Each closure is a
+   * sorted span into one shared arena, and all states in a strongly connected
+   * component of the epsilon graph share a single span. States with nothing
+   * but epsilon transitions out that also don't accept are left out, since
+   * they can't consume input or end a match.
+   */
+  class Closures {
+    friend class FSA;
+
+    std::vector<uint64_t> arena{};
+    // offsets[c]..offsets[c + 1] is the closure of component c
+    std::vector<uint64_t> offsets{0};
+    std::vector<uint64_t> component{};
+
+  public:
+    std::span<const uint64_t> operator[](uint64_t state) const {
+      const uint64_t c = component[state];
+      return {arena.data() + offsets[c], arena.data() + offsets[c + 1]};
+    }
+  };
+
+  // Hash of a sorted set of states, for looking up subsets
+  struct StateSetHash {
+    size_t operator()(const std::vector<uint64_t> &states) const;
+  };
+
 private:
   uint64_t start_state{0};
   // transitions indexed by start. can't use a map for the transitions because
@@ -33,28 +97,63 @@ private:
 
   std::set<uint64_t> accept_states{};
 
-  std::set<uint64_t> EpsilonClosure(uint64_t state) const;
+  // Optional tags on accept states, e.g. to tell which of several unioned
+  // patterns accepted. Kept through union, determinization and minimization
+  std::map<uint64_t, std::set<uint64_t>> accept_tags{};
 
 public:
   void AddStates(uint64_t how_many = 1);
 
   void AcceptState(uint64_t state);
 
+  // Add tag to every current accept state
+  void TagAcceptStates(uint64_t tag);
+
+  const std::set<uint64_t> &AcceptTags(uint64_t state) const;
+
   void StartState(uint64_t state);
 
   void AddTransition(uint64_t from, uint64_t to, int64_t label);
 
-  // Consume a String. Currently ub if the FSA is not deterministic.
-  bool ConsumeString(std::vector<int64_t> toks) const;
+  // Transition on every label in [lo, hi]
+  void AddTransition(uint64_t from, uint64_t to, int64_t lo, int64_t hi);
+
+  Closures EpsilonClosures() const;
+
+  uint64_t NumStates() const { return transitions.size(); }
+
+  uint64_t NumTransitions() const;
+
+  // Bytes taken up by the transitions
+  uint64_t MemoryUsage() const;
+
+  uint64_t StartState() const { return start_state; }
+
+  bool IsAcceptState(uint64_t state) const {
+    return accept_states.contains(state);
+  }
 
-  bool ConsumeRange(std::vector<int64_t>::const_iterator begin, std::vector<int64_t>::const_iterator end, uint64_t state) const;
+  const std::vector<Transition> &TransitionsFrom(uint64_t state) const {
+    return transitions[state];
+  }
 
-  void Determinize();
+  // Consume a String. Currently ub if the FSA is not deterministic.
+  bool ConsumeString(std::span<const int64_t> toks) const;
 
-  inline void Minimize() {
-    // TODO
+  bool ConsumeString(std::initializer_list<int64_t> toks) const {
+    return ConsumeString(std::span<const int64_t>(toks.begin(), toks.size()));
   }
 
+  bool ConsumeRange(std::span<const int64_t> toks, uint64_t state) const;
+
+  // Fills in the closure, subset and peak bytes counters of stats, if given
+  void Determinize(CompileStats *stats = nullptr);
+
+  // Hopcroft's partition refinement. Only valid on a deterministic FSA, so
+  // call Determinize first. Unreachable and dead states are dropped. Fills in
+  // the minimization peak bytes of stats, if given
+  void Minimize(CompileStats *stats = nullptr);
+
   bool Empty() const;
 
   static FSA Concatenate(const FSA &left, const FSA &right);
@@ -63,7 +162,12 @@ public:
 
   static FSA Closure(const FSA &left);
 
+  // Accepts exactly the reversed strings of fsa
+  static FSA Reverse(const FSA &fsa);
+
   friend std::ostream &operator<<(std::ostream &os, const FSA &fsa);
+
+  friend class NFABuilder;
 };
 
 std::ostream &operator<<(std::ostream &os, const FSA &fsa);
@@ -3,22 +3,42 @@
 /*
  * Implementation of the language frontend for regex. Includes lexer and
  * recursive descent parser. The parser constructs the fsa in place by applying
- * Thompson's constructions to the sub-trees.
+ * Thompson's constructions to the sub-trees, all within one NFABuilder so
+ * compiling is linear in the length of the pattern.
+ *
+ * Everything up to the finished FSA is constexpr, so StaticMatcher can run the
+ * same grammar at compile time, where a pattern that doesn't parse fails the
+ * build.
  */
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "FSA.hpp"
+#include "NFABuilder.hpp"
+#include "Utf8.hpp"
 
 namespace Regex {
+
+struct ParseError {};
+
 enum class TokenType {
   OpenParen,
   CloseParen,
   OpenBrace,
   CloseBrace,
   Dash,
+  OpenCurly,
+  CloseCurly,
+  Comma,
   Plus,
+  Question,
   Star,
   Pipe,
   Character,
@@ -36,10 +56,16 @@ private:
 
   std::vector<Token> toks;
 
+  // Not constexpr, so reaching it at compile time fails the build at the call
+  void Error(std::string_view msg);
+
 public:
-  Lexer(std::string_view str);
+  constexpr Lexer(std::string_view str);
 
-  std::vector<Token> Lex();
+  // Characters are whole UTF-8 sequences. May throw a ParseError if str isn't
+  // valid UTF-8
+
+  constexpr std::vector<Token> Lex();
 };
 
 // character (lr) > closure (bind one on the right)  > concatenation(lr) >
@@ -49,25 +75,356 @@ public:
  * Expression -> Alternation
  * Alternation -> Concatenation ("|"  Concatenation)*
  * Concatenation -> Closure Closure*
- * Closure -> Primary "*"?
- * Primary -> CHARACTER | "(" Expression ")"
+ * Closure -> Primary ("*" | "+" | "?" | "{" Count ("," Count?)? "}")*
+ * Primary -> CHARACTER | "(" Expression ")" | "[" Range+ "]"
+ * Range -> CHARACTER ("-" CHARACTER)?
+ * Count -> DIGIT+
+ *
+ * Outside of brackets and braces, "-", "," and "}" are plain characters.
+ * Inside brackets, everything but "]" is, and a "-" at either end too.
+ * A CHARACTER is one code point, which matches its UTF-8 encoding, and ranges
+ * in brackets are ranges of code points.
  */
 class Parser {
+public:
+  using Fragment = NFABuilder::Fragment;
+
 private:
   std::vector<Token> toks;
   std::vector<Token>::const_iterator current;
 
+  NFABuilder nfa;
+
+  // Whether groups get tagged, and how many have been seen
+  bool captures;
+  uint64_t n_groups{0};
+
   void Error(std::string_view msg);
 
-  FSA Expression();
-  FSA Alternation();
-  FSA Concatenation();
-  FSA Closure();
-  FSA Primary();
+  constexpr Fragment Expression();
+  constexpr Fragment Alternation();
+  constexpr Fragment Concatenation();
+  constexpr Fragment Closure();
+  constexpr Fragment Primary();
+  constexpr Fragment Class();
+  constexpr uint64_t Count();
 
 public:
-  Parser(std::vector<Token> toks);
+  // Largest count allowed in {n,m}, since every count is a copy of the
+  // repeated expression
+  static constexpr uint64_t MaxRepeat{1000};
+
+  /*
+   * With captures, group i (counting opening parentheses from 0) is wrapped
+   * in the tags 2i and 2i + 1, marking where it starts and ends
+   */
+  constexpr Parser(std::vector<Token> toks, bool captures = false);
   FSA Parse();
+
+  /*
+   * Parses into Nfa() without moving the result out into an FSA, for building
+   * something other than an FSA from the arena. Parse goes through here too,
+   * so both reject the same patterns
+   */
+  constexpr Fragment ParseFragment();
+
+  constexpr const NFABuilder &Nfa() const { return nfa; }
+
+  constexpr uint64_t NumGroups() const { return n_groups; }
 };
 
+constexpr Parser::Parser(std::vector<Token> toks, bool captures)
+    : toks(std::move(toks)), captures(captures) {
+  this->current = this->toks.begin();
+}
+
+constexpr Parser::Fragment Parser::ParseFragment() {
+  const Fragment fragment = Expression();
+  if (current != toks.end())
+    Error("Did not consume all tokens");
+  return fragment;
+}
+
+constexpr Parser::Fragment Parser::Expression() { return Alternation(); }
+
+// All the branches are collected first so they hang off a single new start
+// state, instead of nesting one union per "|"
+constexpr Parser::Fragment Parser::Alternation() {
+  std::vector<Fragment> branches{Concatenation()};
+
+  while (current != toks.end() && current->type == TokenType::Pipe) {
+    ++current;
+    branches.push_back(Concatenation());
+  }
+
+  if (branches.size() == 1)
+    return branches.front();
+
+  for (const Fragment &branch : branches) {
+    if (branch.Empty())
+      Error("Empty alternative");
+  }
+
+  return nfa.Alternate(branches);
+}
+
+constexpr Parser::Fragment Parser::Concatenation() {
+  Fragment alt = Closure();
+
+  while (current != toks.end()) {
+    Fragment right = Closure();
+    if (right.Empty())
+      break;
+
+    alt = nfa.Concatenate(alt, right);
+  }
+
+  return alt;
+}
+
+constexpr Parser::Fragment Parser::Closure() {
+  using enum TokenType;
+  Fragment clos = Primary();
+
+  while (current != toks.end()) {
+    const TokenType type = current->type;
+    if (type != Star && type != Plus && type != Question && type != OpenCurly)
+      break;
+    ++current;
+
+    if (clos.Empty())
+      Error("Cannot apply repetition to empty expression");
+
+    if (type == Star) {
+      clos = nfa.Closure(clos);
+    } else if (type == Plus) {
+      clos = nfa.Repeat(clos, 1, std::nullopt);
+    } else if (type == Question) {
+      clos = nfa.Repeat(clos, 0, 1);
+    } else {
+      const uint64_t min = Count();
+      std::optional<uint64_t> max{min};
+
+      if (current != toks.end() && current->type == Comma) {
+        ++current;
+        max = std::nullopt;
+        if (current != toks.end() && current->type != CloseCurly)
+          max = Count();
+      }
+
+      if (current == toks.end() || current->type != CloseCurly)
+        Error("Unclosed repetition count");
+      ++current;
+
+      if (max && *max < min)
+        Error("Repetition range is backwards");
+      clos = nfa.Repeat(clos, min, max);
+    }
+  }
+
+  return clos;
+}
+
+constexpr uint64_t Parser::Count() {
+  uint64_t count{0};
+  bool digits{false};
+
+  while (current != toks.end() && current->type == TokenType::Character &&
+         current->lexeme[0] >= '0' && current->lexeme[0] <= '9') {
+    count = count * 10 + (current->lexeme[0] - '0');
+    if (count > MaxRepeat)
+      Error("Repetition count too large");
+    digits = true;
+    ++current;
+  }
+
+  if (!digits)
+    Error("Expected repetition count");
+
+  return count;
+}
+
+/*
+ * The ranges of code points are sorted and merged, then split into UTF-8
+ * sequences of byte ranges, each range a single transition. Sequences are
+ * built back to front through a cache of (range, target) states, so ones that
+ * end the same way share their tails, e.g. every sequence ending in a full
+ * continuation byte uses the same last state. Even all of Unicode only makes
+ * a few dozen tails, so the cache is searched linearly.
+ */
+constexpr Parser::Fragment Parser::Class() {
+  std::vector<std::pair<char32_t, char32_t>> ranges;
+
+  auto code_point = [](const Token &tok) {
+    char32_t cp{0};
+    [[maybe_unused]] const size_t length = Utf8::Decode(tok.lexeme, cp);
+    assert(length == tok.lexeme.size());
+    return cp;
+  };
+
+  while (current != toks.end() && current->type != TokenType::CloseBrace) {
+    const char32_t lo = code_point(*current);
+    ++current;
+
+    char32_t hi = lo;
+    if (current != toks.end() && current->type == TokenType::Dash &&
+        current + 1 != toks.end() &&
+        (current + 1)->type != TokenType::CloseBrace) {
+      hi = code_point(*(current + 1));
+      current += 2;
+      if (hi < lo)
+        Error("Character range is backwards");
+    }
+
+    ranges.emplace_back(lo, hi);
+  }
+
+  if (current == toks.end())
+    Error("Unclosed character class");
+  ++current;
+
+  if (ranges.empty())
+    Error("Empty character class");
+
+  std::sort(ranges.begin(), ranges.end());
+
+  std::vector<std::pair<char32_t, char32_t>> merged{ranges.front()};
+  for (const auto &[lo, hi] : ranges) {
+    if (lo > merged.back().second + 1)
+      merged.emplace_back(lo, hi);
+    else
+      merged.back().second = std::max(merged.back().second, hi);
+  }
+
+  const NFABuilder::Mark mark = nfa.Here();
+  const uint64_t start = nfa.AddStates();
+  const uint64_t accept = nfa.AddStates();
+
+  struct Tail {
+    Utf8::ByteRange range;
+    uint64_t to;
+    uint64_t state;
+  };
+  std::vector<Tail> tails;
+
+  for (const auto &[lo, hi] : merged) {
+    for (const Utf8::Sequence &seq : Utf8::Sequences(lo, hi)) {
+      uint64_t to = accept;
+      for (size_t i = seq.length - 1; i > 0; --i) {
+        const Utf8::ByteRange range = seq.ranges[i];
+        auto it = std::find_if(tails.begin(), tails.end(), [&](const Tail &t) {
+          return t.range == range && t.to == to;
+        });
+        if (it == tails.end()) {
+          tails.push_back({range, to, nfa.AddStates()});
+          nfa.AddTransition(tails.back().state, to, range.lo, range.hi);
+          it = tails.end() - 1;
+        }
+        to = it->state;
+      }
+      nfa.AddTransition(start, to, seq.ranges[0].lo, seq.ranges[0].hi);
+    }
+  }
+
+  return nfa.Since(mark, start, accept);
+}
+
+constexpr Parser::Fragment Parser::Primary() {
+  Fragment fragment;
+
+  if (current == toks.end()) {
+    return fragment;
+  } else if (current->type == TokenType::Character ||
+             current->type == TokenType::Dash ||
+             current->type == TokenType::Comma ||
+             current->type == TokenType::CloseCurly) {
+    // One transition per byte of the encoding
+    const std::string &bytes = current->lexeme;
+    const NFABuilder::Mark mark = nfa.Here();
+    const uint64_t first = nfa.AddStates(bytes.size() + 1);
+    for (size_t i = 0; i < bytes.size(); ++i)
+      nfa.AddTransition(first + i, first + i + 1,
+                        static_cast<uint8_t>(bytes[i]));
+    fragment = nfa.Since(mark, first, first + bytes.size());
+    ++current;
+  } else if (current->type == TokenType::OpenParen) {
+    ++current;
+    const uint64_t group = n_groups++;
+    fragment = Expression();
+    if (current == toks.end() || current->type != TokenType::CloseParen)
+      Error("Unclosed parentheses");
+    ++current;
+
+    if (captures)
+      fragment = nfa.Tagged(fragment, 2 * group, 2 * group + 1);
+  } else if (current->type == TokenType::OpenBrace) {
+    ++current;
+    fragment = Class();
+  }
+
+  return fragment;
+}
+
+constexpr Lexer::Lexer(std::string_view str) : str(str) {
+  current = this->str.begin();
+}
+
+constexpr std::vector<Token> Lexer::Lex() {
+  using enum TokenType;
+  while (current != str.end()) {
+    char cur = *(current++);
+
+    switch (cur) {
+    case '(':
+      toks.emplace_back(OpenParen, "(");
+      break;
+    case ')':
+      toks.emplace_back(CloseParen, ")");
+      break;
+    case '[':
+      toks.emplace_back(OpenBrace, "[");
+      break;
+    case ']':
+      toks.emplace_back(CloseBrace, "]");
+      break;
+    case '-':
+      toks.emplace_back(Dash, "-");
+      break;
+    case '{':
+      toks.emplace_back(OpenCurly, "{");
+      break;
+    case '}':
+      toks.emplace_back(CloseCurly, "}");
+      break;
+    case ',':
+      toks.emplace_back(Comma, ",");
+      break;
+    case '+':
+      toks.emplace_back(Plus, "+");
+      break;
+    case '?':
+      toks.emplace_back(Question, "?");
+      break;
+    case '*':
+      toks.emplace_back(Star, "*");
+      break;
+    case '|':
+      toks.emplace_back(Pipe, "|");
+      break;
+    default: {
+      char32_t cp{0};
+      const size_t length =
+          Utf8::Decode(std::string_view(current - 1, str.cend()), cp);
+      if (length == 0)
+        Error("Invalid UTF-8");
+      toks.emplace_back(Character,
+                        std::string(current - 1, current - 1 + length));
+      current += length - 1;
+      break;
+    }
+    }
+  }
+  return toks;
+}
+
 } // namespace Regex
@@ -0,0 +1,174 @@
+#include "LazyDFA.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+// Give up on the cache when it gets flushed this many times during a single
+// match while consuming fewer than BytesPerState bytes for every state built
+constexpr uint64_t MinFlushes{3};
+constexpr uint64_t BytesPerState{10};
+
+} // namespace
+
+LazyDFA::LazyDFA(FSA nfa, uint64_t capacity)
+    : nfa(std::move(nfa)), closures(this->nfa.EpsilonClosures()),
+      classes(this->nfa),
+      capacity(std::max<uint64_t>(capacity, 3)),
+      seen(this->nfa.NumStates(), std::numeric_limits<uint64_t>::max()) {
+  Flush();
+  flushes = 0;
+}
+
+void LazyDFA::Flush() {
+  ++flushes;
+
+  table.clear();
+  accept_states.clear();
+  ids.clear();
+  state_sets.clear();
+
+  AddState({});
+
+  // With no states at all there is nothing to match, so start out dead
+  if (nfa.NumStates() == 0)
+    return;
+
+  std::span<const uint64_t> start = closures[nfa.StartState()];
+  start_state = AddState(StateSet(start.begin(), start.end()));
+}
+
+uint32_t LazyDFA::AddState(const StateSet &states) {
+  auto [it, inserted] = ids.try_emplace(states, state_sets.size());
+  if (!inserted)
+    return it->second;
+
+  state_sets.push_back(&it->first);
+  accept_states.push_back(IsAccepting(it->first));
+  // The dead state's row is already known
+  table.resize(table.size() + classes.NumClasses(),
+               state_sets.size() == 1 ? Dead : Unknown);
+
+  return it->second;
+}
+
+bool LazyDFA::IsAccepting(std::span<const uint64_t> states) const {
+  return std::any_of(states.begin(), states.end(), [this](uint64_t state) {
+    return nfa.IsAcceptState(state);
+  });
+}
+
+void LazyDFA::Step(std::span<const uint64_t> states, uint8_t byte) {
+  scratch.clear();
+  ++stamp;
+
+  for (uint64_t state : states) {
+    for (const FSA::Transition &trans : nfa.TransitionsFrom(state)) {
+      if (!trans.Covers(byte))
+        continue;
+
+      for (uint64_t reached : closures[trans.to]) {
+        if (seen[reached] != stamp) {
+          seen[reached] = stamp;
+          scratch.push_back(reached);
+        }
+      }
+    }
+  }
+
+  std::sort(scratch.begin(), scratch.end());
+}
+
+uint32_t LazyDFA::Compute(uint32_t state, uint8_t byte) {
+  Step(*state_sets[state], byte);
+
+  auto found = ids.find(scratch);
+  if (found != ids.end()) {
+    table[state * classes.NumClasses() + classes[byte]] = found->second;
+    return found->second;
+  }
+
+  if (state_sets.size() >= capacity) {
+    // scratch holds the only set still needed, so nothing else survives
+    Flush();
+    return AddState(scratch);
+  }
+
+  const uint32_t next = AddState(scratch);
+  table[state * classes.NumClasses() + classes[byte]] = next;
+  return next;
+}
+
+bool LazyDFA::Simulate(uint32_t state, std::span<const uint8_t> rest,
+                       MatchTrace &trace) {
+  ++fallbacks;
+
+  simulated.assign(state_sets[state]->begin(), state_sets[state]->end());
+
+  for (uint64_t i = 0; i < rest.size(); ++i) {
+    Step(simulated, rest[i]);
+    std::swap(simulated, scratch);
+
+    if (simulated.empty()) {
+      trace = {i + 1, true};
+      return false;
+    }
+  }
+
+  trace = {rest.size(), false};
+  return IsAccepting(simulated);
+}
+
+bool LazyDFA::Match(std::span<const uint8_t> input) {
+  MatchTrace trace;
+  return Match(input, trace);
+}
+
+bool LazyDFA::Match(std::span<const uint8_t> input, MatchTrace &trace) {
+  uint32_t state = start_state;
+
+  const uint64_t stride = classes.NumClasses();
+  const uint64_t flushes_before = flushes;
+  uint64_t last_flush = 0;
+
+  for (uint64_t i = 0; i < input.size(); ++i) {
+    uint32_t next = table[state * stride + classes[input[i]]];
+
+    if (next == Unknown) {
+      const uint64_t flushes_seen = flushes;
+      next = Compute(state, input[i]);
+
+      if (flushes != flushes_seen) {
+        if (flushes - flushes_before >= MinFlushes &&
+            i - last_flush < BytesPerState * capacity) {
+          const bool matched = Simulate(next, input.subspan(i + 1), trace);
+          trace.steps += i + 1;
+          return matched;
+        }
+
+        last_flush = i;
+      }
+    }
+
+    if (next == Dead) {
+      trace = {i + 1, true};
+      return false;
+    }
+
+    state = next;
+  }
+
+  trace = {input.size(), false};
+  return accept_states[state];
+}
+
+bool LazyDFA::Match(std::string_view input) {
+  return Match(std::span<const uint8_t>(
+      reinterpret_cast<const uint8_t *>(input.data()), input.size()));
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ByteClasses.hpp"
+#include "FSA.hpp"
+#include "Stats.hpp"
+
+/*
+ * DFA built on the fly from an NFA. A DFA state is only created the first time
+ * the input reaches it, by stepping the NFA subset it stands for, and is then
+ * kept in a cache with the same dense [state][byte class] layout as DFA. The
+ * cache holds at most a fixed number of states and is flushed when full, so
+ * memory stays bounded even for patterns whose full DFA is exponential in
+ * size. If the cache keeps getting flushed without the input making much
+ * progress, the rest of that input is matched by stepping NFA subsets
+ * directly instead.
+ */
+class LazyDFA {
+public:
+  static constexpr uint32_t Dead{0};
+  static constexpr uint32_t Unknown{UINT32_MAX};
+  static constexpr uint64_t AlphabetSize{256};
+
+  static constexpr uint64_t DefaultCapacity{1024};
+
+private:
+  using StateSet = std::vector<uint64_t>;
+
+  FSA nfa;
+  FSA::Closures closures;
+  ByteClasses classes;
+  uint64_t capacity;
+
+  uint32_t start_state{Dead};
+
+  std::vector<uint32_t> table{};
+  std::vector<bool> accept_states{};
+  std::unordered_map<StateSet, uint32_t, FSA::StateSetHash> ids{};
+  // Points into the keys of ids
+  std::vector<const StateSet *> state_sets{};
+
+  uint64_t flushes{0};
+  uint64_t fallbacks{0};
+
+  // Scratch space reused between steps and matches
+  StateSet scratch{};
+  StateSet simulated{};
+  std::vector<uint64_t> seen{};
+  uint64_t stamp{0};
+
+  void Flush();
+
+  uint32_t AddState(const StateSet &states);
+
+  // Subset reached from states on byte, into scratch
+  void Step(std::span<const uint64_t> states, uint8_t byte);
+
+  bool IsAccepting(std::span<const uint64_t> states) const;
+
+  // Fill in the transition of state on byte. May flush the cache, after which
+  // only the returned id is valid
+  uint32_t Compute(uint32_t state, uint8_t byte);
+
+  // Plain subset simulation for the rest of the input
+  bool Simulate(uint32_t state, std::span<const uint8_t> rest,
+                MatchTrace &trace);
+
+public:
+  // Takes the NFA as is; it should not be determinized beforehand. capacity
+  // is the maximum number of DFA states kept at once
+  explicit LazyDFA(FSA nfa, uint64_t capacity = DefaultCapacity);
+
+  bool Match(std::span<const uint8_t> input);
+
+  bool Match(std::string_view input);
+
+  // Match, also noting how many bytes were consumed and whether it died
+  bool Match(std::span<const uint8_t> input, MatchTrace &trace);
+
+  uint64_t NumCachedStates() const { return state_sets.size(); }
+
+  uint64_t NumFlushes() const { return flushes; }
+
+  uint64_t NumFallbacks() const { return fallbacks; }
+};
@@ -0,0 +1,21 @@
+#include "MatchState.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+bool MatchState::Feed(std::span<const uint8_t> piece) {
+  for (uint8_t byte : piece) {
+    state = dfa->Next(state, byte);
+
+    if (state == DFA::Dead)
+      return false;
+  }
+
+  return state != DFA::Dead;
+}
+
+bool MatchState::Feed(std::string_view piece) {
+  return Feed(std::span<const uint8_t>(
+      reinterpret_cast<const uint8_t *>(piece.data()), piece.size()));
+}
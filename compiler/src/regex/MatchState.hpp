@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "DFA.hpp"
+
+/*
+ * Whole-input match over input that arrives in pieces. Only the DFA state
+ * reached so far is carried from one piece to the next, so nothing is
+ * buffered and the memory used doesn't depend on the input's length. Once the
+ * state is dead no continuation can match, and Feed says so, so the caller can
+ * drop the rest of the input. The DFA must outlive the state.
+ */
+class MatchState {
+private:
+  const DFA *dfa;
+  uint32_t state;
+
+public:
+  explicit MatchState(const DFA &dfa)
+      : dfa(&dfa), state(dfa.StartState()) {}
+
+  /*
+   * Consume the next piece of input. Returns false once nothing can match any
+   * more, whatever follows
+   */
+  bool Feed(std::span<const uint8_t> piece);
+
+  bool Feed(std::string_view piece);
+
+  /*
+   * Check if everything fed so far is in the language
+   */
+  bool Finish() const { return dfa->IsAcceptState(state); }
+
+  bool Dead() const { return state == DFA::Dead; }
+
+  // Start over on a new input
+  void Reset() { state = dfa->StartState(); }
+};
@@ -0,0 +1,32 @@
+#include "NFABuilder.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Counting sort of the arena by source state, which keeps the order within
+ * each state and sizes every state's transitions exactly once
+ */
+FSA NFABuilder::Finish(const Fragment &fragment) {
+  FSA fsa;
+
+  if (!fragment.Empty()) {
+    std::vector<uint64_t> counts(n_states, 0);
+    for (const Edge &edge : edges)
+      ++counts[edge.from];
+
+    fsa.transitions.resize(n_states);
+    for (uint64_t state = 0; state < n_states; ++state)
+      fsa.transitions[state].reserve(counts[state]);
+    for (const Edge &edge : edges)
+      fsa.transitions[edge.from].push_back(edge.trans);
+
+    fsa.start_state = fragment.start;
+    fsa.accept_states = {fragment.accept};
+  }
+
+  n_states = 0;
+  edges.clear();
+
+  return fsa;
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "FSA.hpp"
+
+/*
+ * Thompson's constructions done in place. FSA::Concatenate and friends copy
+ * both of their operands, so a parser folding a pattern together with them
+ * copies the left side once per operator and compiles in quadratic time.
+ * Here every state and transition of the pattern goes into one arena, and a
+ * fragment is just a range of it with a start and an accept state, so
+ * combining fragments only adds the few epsilon transitions that join them.
+ *
+ * Fragments are built bottom up, as a parser produces them, so a fragment's
+ * states and transitions are always the contiguous ranges of the arena added
+ * while it was built. That's what lets Repeat copy one.
+ *
+ * Everything but Finish is constexpr, so the parser can build a pattern's NFA
+ * at compile time too, see StaticRegex.
+ */
+class NFABuilder {
+public:
+  struct Fragment {
+    uint64_t start{0};
+    uint64_t accept{0};
+    // States [states_begin, states_end) and transitions [edges_begin,
+    // edges_end) of the arena
+    uint64_t states_begin{0};
+    uint64_t states_end{0};
+    uint64_t edges_begin{0};
+    uint64_t edges_end{0};
+
+    // Matches nothing at all, like an FSA with no states. Combining anything
+    // with an empty fragment leaves it unchanged
+    constexpr bool Empty() const { return states_begin == states_end; }
+  };
+
+  // Where the arena ends, for building a fragment by hand
+  struct Mark {
+    uint64_t states;
+    uint64_t edges;
+  };
+
+  struct Edge {
+    uint64_t from;
+    FSA::Transition trans;
+  };
+
+private:
+  uint64_t n_states{0};
+  std::vector<Edge> edges{};
+
+public:
+  constexpr Mark Here() const { return {n_states, edges.size()}; }
+
+  constexpr uint64_t NumStates() const { return n_states; }
+
+  // Every transition added so far, in the order it was added
+  constexpr std::span<const Edge> Edges() const { return edges; }
+
+  // Returns the first of the new states
+  constexpr uint64_t AddStates(uint64_t how_many = 1);
+
+  constexpr void AddTransition(uint64_t from, uint64_t to, int64_t label) {
+    edges.push_back({from, {label, to}});
+  }
+
+  constexpr void AddTransition(uint64_t from, uint64_t to, int64_t lo,
+                               int64_t hi) {
+    edges.push_back({from, {lo, to, hi}});
+  }
+
+  // Everything added since mark, as a fragment
+  constexpr Fragment Since(Mark mark, uint64_t start,
+                           uint64_t accept) const;
+
+  // left then right. right must have been built after left
+  constexpr Fragment Concatenate(const Fragment &left, const Fragment &right);
+
+  // One new start state with an epsilon transition to each branch in order,
+  // however many there are. The branches must have been built in order
+  constexpr Fragment Alternate(std::span<const Fragment> branches);
+
+  constexpr Fragment Closure(const Fragment &fragment);
+
+  /*
+   * Between min and max repetitions of fragment, or at least min when max is
+   * nullopt. fragment is the first copy and the rest are appended after it.
+   * The optional copies nest, as in x(x(x)?)?, rather than being a run of x?,
+   * so the subsets determinizing them stay small
+   */
+  constexpr Fragment Repeat(const Fragment &fragment, uint64_t min,
+                            std::optional<uint64_t> max);
+
+  // fragment between a transition on tag open and one on tag close
+  constexpr Fragment Tagged(const Fragment &fragment, uint64_t open,
+                            uint64_t close);
+
+  // Moves the arena out into an FSA, with fragment's start and accept states.
+  // Transitions out of each state keep the order they were added in
+  FSA Finish(const Fragment &fragment);
+};
+
+constexpr uint64_t NFABuilder::AddStates(uint64_t how_many) {
+  const uint64_t first = n_states;
+  n_states += how_many;
+  return first;
+}
+
+constexpr NFABuilder::Fragment
+NFABuilder::Since(Mark mark, uint64_t start, uint64_t accept) const {
+  assert(mark.states <= start && start < n_states);
+  assert(mark.states <= accept && accept < n_states);
+
+  return {start, accept, mark.states, n_states, mark.edges, edges.size()};
+}
+
+constexpr NFABuilder::Fragment
+NFABuilder::Concatenate(const Fragment &left, const Fragment &right) {
+  if (left.Empty())
+    return right;
+  if (right.Empty())
+    return left;
+
+  assert(left.states_end <= right.states_begin);
+
+  const Mark mark{left.states_begin, left.edges_begin};
+  AddTransition(left.accept, right.start, FSA::Eps);
+  return Since(mark, left.start, right.accept);
+}
+
+constexpr NFABuilder::Fragment
+NFABuilder::Alternate(std::span<const Fragment> branches) {
+  if (branches.size() == 1)
+    return branches.front();
+
+  assert(!branches.empty());
+
+  const Mark mark{branches.front().states_begin, branches.front().edges_begin};
+  const uint64_t start = AddStates();
+  const uint64_t accept = AddStates();
+
+  for (const Fragment &branch : branches) {
+    assert(!branch.Empty());
+    AddTransition(start, branch.start, FSA::Eps);
+    AddTransition(branch.accept, accept, FSA::Eps);
+  }
+
+  return Since(mark, start, accept);
+}
+
+/*
+ * Same shape as FSA::Closure, with the transitions in the same order of
+ * preference so the star stays greedy
+ */
+constexpr NFABuilder::Fragment
+NFABuilder::Closure(const Fragment &fragment) {
+  assert(!fragment.Empty());
+
+  const Mark mark{fragment.states_begin, fragment.edges_begin};
+  const uint64_t start = AddStates();
+  const uint64_t accept = AddStates();
+
+  AddTransition(start, fragment.start, FSA::Eps);
+  AddTransition(start, accept, FSA::Eps);
+  AddTransition(fragment.accept, fragment.start, FSA::Eps);
+  AddTransition(fragment.accept, accept, FSA::Eps);
+
+  return Since(mark, start, accept);
+}
+
+/*
+ * A new start state, then the copies one after another, then a new final
+ * state. The accept state of each copy leads on to the next copy, and once
+ * min copies are done it can also skip straight to the final state. So the
+ * optional copies nest instead of each being an x? of its own, and no two
+ * optional copies are live at once. Without a max, the last copy loops back
+ * on itself like a closure.
+ */
+constexpr NFABuilder::Fragment
+NFABuilder::Repeat(const Fragment &fragment, uint64_t min,
+                   std::optional<uint64_t> max) {
+  assert(!fragment.Empty());
+  assert(!max || min <= *max);
+  assert(fragment.states_end == n_states && fragment.edges_end == edges.size());
+
+  const Mark mark{fragment.states_begin, fragment.edges_begin};
+  const uint64_t copies = max ? *max : min + 1;
+  const uint64_t size = fragment.states_end - fragment.states_begin;
+
+  const uint64_t start = AddStates();
+  const uint64_t final_state = AddStates();
+
+  if (copies > 1)
+    edges.reserve(edges.size() +
+                  (copies - 1) * (fragment.edges_end - fragment.edges_begin));
+
+  uint64_t frontier = start;
+
+  for (uint64_t i = 0; i < copies; ++i) {
+    // The fragment itself is the first copy
+    uint64_t offset = 0;
+    if (i > 0) {
+      offset = AddStates(size) - fragment.states_begin;
+      for (uint64_t e = fragment.edges_begin; e < fragment.edges_end; ++e) {
+        const Edge edge = edges[e];
+        AddTransition(edge.from + offset, edge.trans.to + offset,
+                      edge.trans.label, edge.trans.hi);
+      }
+    }
+
+    const uint64_t copy_start = fragment.start + offset;
+    const bool optional = i >= min;
+
+    // Taking another copy is preferred to stopping, as with a greedy star
+    AddTransition(frontier, copy_start, FSA::Eps);
+    if (optional)
+      AddTransition(frontier, final_state, FSA::Eps);
+
+    frontier = fragment.accept + offset;
+
+    if (!max && optional)
+      AddTransition(frontier, copy_start, FSA::Eps);
+  }
+
+  AddTransition(frontier, final_state, FSA::Eps);
+
+  return Since(mark, start, final_state);
+}
+
+constexpr NFABuilder::Fragment
+NFABuilder::Tagged(const Fragment &fragment, uint64_t open, uint64_t close) {
+  if (fragment.Empty())
+    return fragment;
+
+  const Mark mark{fragment.states_begin, fragment.edges_begin};
+  const uint64_t start = AddStates();
+  const uint64_t accept = AddStates();
+
+  AddTransition(start, fragment.start, FSA::Tag(open));
+  AddTransition(fragment.accept, accept, FSA::Tag(close));
+
+  return Since(mark, start, accept);
+}
@@ -0,0 +1,77 @@
+#include "NFASimulator.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+
+NFASimulator::NFASimulator(FSA nfa)
+    : nfa(std::move(nfa)), current(this->nfa.NumStates()),
+      next(this->nfa.NumStates()) {
+  // A state is only pushed when it is first inserted into a set
+  stack.reserve(this->nfa.NumStates());
+}
+
+void NFASimulator::AddState(SparseSet &set, uint64_t state) {
+  if (!set.Insert(state))
+    return;
+
+  stack.push_back(state);
+
+  while (!stack.empty()) {
+    const uint64_t curr_state = stack.back();
+    stack.pop_back();
+
+    for (const FSA::Transition &trans : nfa.TransitionsFrom(curr_state)) {
+      if (FSA::IsEpsilon(trans.label) && set.Insert(trans.to))
+        stack.push_back(trans.to);
+    }
+  }
+}
+
+bool NFASimulator::Match(std::span<const uint8_t> input) {
+  MatchTrace trace;
+  return Match(input, trace);
+}
+
+bool NFASimulator::Match(std::span<const uint8_t> input, MatchTrace &trace) {
+  trace = {0, true};
+  if (nfa.NumStates() == 0)
+    return false;
+
+  current.Clear();
+  AddState(current, nfa.StartState());
+
+  for (uint64_t i = 0; i < input.size(); ++i) {
+    const uint8_t byte = input[i];
+    next.Clear();
+
+    for (uint64_t state : current) {
+      for (const FSA::Transition &trans : nfa.TransitionsFrom(state)) {
+        if (trans.Covers(byte))
+          AddState(next, trans.to);
+      }
+    }
+
+    std::swap(current, next);
+
+    if (current.Empty()) {
+      trace = {i + 1, true};
+      return false;
+    }
+  }
+
+  trace = {input.size(), false};
+
+  for (uint64_t state : current) {
+    if (nfa.IsAcceptState(state))
+      return true;
+  }
+
+  return false;
+}
+
+bool NFASimulator::Match(std::string_view input) {
+  return Match(std::span<const uint8_t>(
+      reinterpret_cast<const uint8_t *>(input.data()), input.size()));
+}
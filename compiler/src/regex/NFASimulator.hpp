@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "FSA.hpp"
+#include "Stats.hpp"
+#include "SparseSet.hpp"
+
+/*
+ * Thompson/Pike style simulation of an NFA. All the states the NFA could be in
+ * are advanced together, one input byte at a time, between two sparse sets.
+ * Every state is added to a set at most once per byte, so matching is
+ * O(n * m) for n input bytes and m NFA states and transitions regardless of the
+ * pattern, with no recursion and no allocation once constructed.
+ */
+class NFASimulator {
+private:
+  FSA nfa;
+
+  SparseSet current;
+  SparseSet next;
+  std::vector<uint64_t> stack{};
+
+  // Add state and everything reachable from it by epsilon transitions
+  void AddState(SparseSet &set, uint64_t state);
+
+public:
+  // Takes the NFA as is, there is no need to determinize it
+  explicit NFASimulator(FSA nfa);
+
+  bool Match(std::span<const uint8_t> input);
+
+  bool Match(std::string_view input);
+
+  // Match, also noting how many bytes were consumed and whether it died
+  bool Match(std::span<const uint8_t> input, MatchTrace &trace);
+};
@@ -0,0 +1,141 @@
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+namespace Parallel {
+
+namespace {
+
+// How many bytes to step all lanes between merging the ones that met
+constexpr uint64_t MergeInterval{16};
+
+} // namespace
+
+ChunkMap::ChunkMap(const DFA &dfa, std::span<const uint8_t> chunk,
+                   bool backwards) {
+  const uint64_t n_states = dfa.NumStates();
+
+  // Lane 0 is the dead state's, which is never stepped since it can't leave.
+  // Every other lane is live
+  lanes.resize(n_states);
+  std::iota(lanes.begin(), lanes.end(), 0);
+  ends = lanes;
+
+  // Lane each distinct state was merged into, UINT32_MAX if none yet. Lanes
+  // that die join the dead one
+  std::vector<uint32_t> merged(n_states, UINT32_MAX);
+  merged[DFA::Dead] = 0;
+  std::vector<uint32_t> renumber;
+
+  uint64_t i = 0;
+  while (i < chunk.size() && ends.size() > 2) {
+    const uint64_t stop = std::min<uint64_t>(i + MergeInterval, chunk.size());
+
+    for (; i < stop; ++i) {
+      const uint8_t byte = backwards ? chunk[chunk.size() - 1 - i] : chunk[i];
+      for (uint64_t lane = 1; lane < ends.size(); ++lane)
+        ends[lane] = dfa.Next(ends[lane], byte);
+    }
+
+    // Lanes sitting in the same state will stay together from here on
+    renumber.resize(ends.size());
+    renumber[0] = 0;
+    uint64_t kept = 1;
+    for (uint64_t lane = 1; lane < ends.size(); ++lane) {
+      uint32_t &slot = merged[ends[lane]];
+      if (slot == UINT32_MAX) {
+        slot = kept;
+        ends[kept++] = ends[lane];
+      }
+      renumber[lane] = slot;
+    }
+
+    for (uint64_t lane = 1; lane < kept; ++lane)
+      merged[ends[lane]] = UINT32_MAX;
+
+    if (kept < ends.size()) {
+      ends.resize(kept);
+      for (uint32_t &lane : lanes)
+        lane = renumber[lane];
+    }
+  }
+
+  // At most one live lane is left, finish it as a plain run
+  if (ends.size() < 2)
+    return;
+
+  uint32_t state = ends[1];
+  if (backwards) {
+    for (uint64_t j = chunk.size() - i; j-- > 0 && state != DFA::Dead;)
+      state = dfa.Next(state, chunk[j]);
+  } else {
+    for (; i < chunk.size() && state != DFA::Dead; ++i)
+      state = dfa.Next(state, chunk[i]);
+  }
+  ends[1] = state;
+}
+
+uint64_t ChunkSize(uint64_t chunk_size) {
+  return std::max<uint64_t>((chunk_size + 63) / 64 * 64, 64);
+}
+
+uint64_t NumChunks(uint64_t size, uint64_t chunk_size) {
+  chunk_size = ChunkSize(chunk_size);
+  return std::max<uint64_t>((size + chunk_size - 1) / chunk_size, 1);
+}
+
+std::vector<uint32_t> EntryStates(const DFA &dfa,
+                                  std::span<const uint8_t> input,
+                                  uint64_t chunk_size, bool backwards) {
+  chunk_size = ChunkSize(chunk_size);
+  const uint64_t n_chunks = NumChunks(input.size(), chunk_size);
+
+  auto chunk = [&](uint64_t k) {
+    return input.subspan(k * chunk_size,
+                         std::min(chunk_size, input.size() - k * chunk_size));
+  };
+  // Position of the kth chunk the DFA sees
+  auto nth = [&](uint64_t k) { return backwards ? n_chunks - 1 - k : k; };
+
+  // The first chunk's entry state is known, so it is run as usual while every
+  // other chunk gets a map
+  std::vector<ChunkMap> maps(n_chunks);
+  uint32_t after_first = dfa.StartState();
+
+  tbb::parallel_for(uint64_t{0}, n_chunks, [&](uint64_t k) {
+    if (k > 0) {
+      maps[k] = ChunkMap(dfa, chunk(nth(k)), backwards);
+      return;
+    }
+
+    std::span<const uint8_t> first = chunk(nth(0));
+    for (uint64_t i = 0; i < first.size() && after_first != DFA::Dead; ++i)
+      after_first = dfa.Next(
+          after_first, backwards ? first[first.size() - 1 - i] : first[i]);
+  });
+
+  // Chain the maps from there, in the order the DFA sees the chunks
+  std::vector<uint32_t> entries(n_chunks + 1);
+  entries[nth(0)] = dfa.StartState();
+  uint32_t state = after_first;
+  for (uint64_t k = 1; k < n_chunks; ++k) {
+    entries[nth(k)] = state;
+    state = maps[k](state);
+  }
+  entries[n_chunks] = state;
+
+  return entries;
+}
+
+uint32_t Run(const DFA &dfa, std::span<const uint8_t> input,
+             uint64_t chunk_size) {
+  return EntryStates(dfa, input, chunk_size, false).back();
+}
+
+} // namespace Parallel
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "DFA.hpp"
+
+/*
+ * Splitting one DFA scan across cores. The state a chunk of input is entered
+ * in depends on every chunk before it, so instead each chunk is run from
+ * every state at once, giving the chunk's transition function. Runs from
+ * different states tend to merge within a few bytes, and runs that die join
+ * the dead state's, which is never stepped, so once every live run has met
+ * the chunk costs no more than a single run. Chaining the functions from the
+ * start state then gives the state each chunk is entered in, without touching
+ * the input again.
+ */
+namespace Parallel {
+
+// Inputs shorter than this aren't worth splitting
+constexpr uint64_t DefaultChunkSize{1 << 20};
+
+// State reached from every state of a DFA over one chunk
+class ChunkMap {
+private:
+  // State s ends up in ends[lanes[s]]
+  std::vector<uint32_t> lanes{};
+  std::vector<uint32_t> ends{};
+
+public:
+  ChunkMap() = default;
+
+  // Runs chunk through dfa from every state, last byte first if backwards
+  ChunkMap(const DFA &dfa, std::span<const uint8_t> chunk, bool backwards);
+
+  uint32_t operator()(uint32_t state) const { return ends[lanes[state]]; }
+};
+
+// Number of chunks input is split into, each chunk_size long but the last.
+// chunk_size is rounded up to a multiple of 64 so that chunks own whole words
+// of position bitmaps
+uint64_t NumChunks(uint64_t size, uint64_t chunk_size);
+
+uint64_t ChunkSize(uint64_t chunk_size);
+
+/*
+ * State dfa is in when it enters each chunk, run forwards from the start of
+ * input or backwards from its end, followed by the state it ends up in after
+ * all of input. Chunks are numbered from the start of input either way
+ */
+std::vector<uint32_t> EntryStates(const DFA &dfa,
+                                  std::span<const uint8_t> input,
+                                  uint64_t chunk_size, bool backwards);
+
+// Same state as dfa.Run(input)
+uint32_t Run(const DFA &dfa, std::span<const uint8_t> input,
+             uint64_t chunk_size = DefaultChunkSize);
+
+} // namespace Parallel
@@ -0,0 +1,62 @@
+#include "PatternSet.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "LangFrontend.hpp"
+
+namespace Regex {
+
+PatternSet::PatternSet(std::span<const std::string_view> patterns)
+    : n_patterns(patterns.size()) {
+  std::vector<FSA> fsas;
+
+  for (uint64_t i = 0; i < patterns.size(); ++i) {
+    Lexer lex(patterns[i]);
+    Parser parser(lex.Lex());
+    FSA pattern = parser.Parse();
+
+    // Empty patterns match nothing, so they have nothing to contribute
+    if (pattern.Empty())
+      continue;
+
+    pattern.TagAcceptStates(i);
+    fsas.push_back(std::move(pattern));
+  }
+
+  // Union pairwise so each state is copied O(log n) times rather than O(n)
+  while (fsas.size() > 1) {
+    std::vector<FSA> merged;
+    for (uint64_t i = 0; i + 1 < fsas.size(); i += 2)
+      merged.push_back(FSA::Union(fsas[i], fsas[i + 1]));
+    if (fsas.size() % 2)
+      merged.push_back(std::move(fsas.back()));
+    fsas = std::move(merged);
+  }
+
+  if (fsas.empty())
+    return;
+
+  fsa = std::move(fsas.front());
+  fsa.Determinize();
+  fsa.Minimize();
+  dfa = DFA(fsa);
+}
+
+std::span<const uint64_t> PatternSet::Match(std::string_view str) const {
+  return Match(std::span<const uint8_t>(
+      reinterpret_cast<const uint8_t *>(str.data()), str.size()));
+}
+
+std::span<const uint64_t>
+PatternSet::Match(std::span<const uint8_t> str) const {
+  return dfa.AcceptTags(dfa.Run(str));
+}
+
+bool PatternSet::MatchAny(std::string_view str) const {
+  return dfa.Match(str);
+}
+
+} // namespace Regex
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <ostream>
+#include <span>
+#include <string_view>
+
+#include "DFA.hpp"
+#include "FSA.hpp"
+
+namespace Regex {
+
+/*
+ * Many patterns compiled into one automaton. Each pattern's accept states are
+ * tagged with its index before everything is unioned, determinized and
+ * minimized once, so a single pass over the input finds every pattern that
+ * matches it.
+ */
+class PatternSet {
+private:
+  uint64_t n_patterns;
+  FSA fsa;
+  DFA dfa;
+
+public:
+  /*
+   * Ctor. May throw a ParseError
+   */
+  PatternSet(std::span<const std::string_view> patterns);
+
+  PatternSet(std::initializer_list<std::string_view> patterns)
+      : PatternSet(std::span<const std::string_view>(patterns.begin(),
+                                                    patterns.size())) {}
+
+  uint64_t Size() const { return n_patterns; }
+
+  // Bytes taken up by the compiled automaton
+  uint64_t MemoryUsage() const { return dfa.MemoryUsage(); }
+
+  /*
+   * Indices of the patterns matching the whole input, in ascending order. The
+   * span points into the set itself, so nothing is allocated
+   */
+  std::span<const uint64_t> Match(std::string_view) const;
+
+  std::span<const uint64_t> Match(std::span<const uint8_t>) const;
+
+  /*
+   * Check if any pattern matches the input
+   */
+  bool MatchAny(std::string_view) const;
+
+  /*
+   * Write the compiled set for MappedMatcher to load
+   */
+  void Save(std::ostream &out) const { dfa.Serialize(out); }
+
+  inline void PrintFsa() {
+	  std::cout << fsa;
+  }
+};
+
+} // namespace Regex
@@ -0,0 +1,300 @@
+#include "Prefilter.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__SSE2__)
+#include <immintrin.h>
+#define REGEX_PREFILTER_X86 1
+#endif
+
+namespace {
+
+// Up to MaxBytes bytes, padded by repeating the first so that comparing
+// against all three is always valid
+struct Needles {
+  uint8_t b0, b1, b2;
+
+  explicit Needles(std::span<const uint8_t> bytes)
+      : b0(bytes[0]), b1(bytes.size() > 1 ? bytes[1] : bytes[0]),
+        b2(bytes.size() > 2 ? bytes[2] : bytes[0]) {}
+
+  bool Contains(uint8_t byte) const {
+    return byte == b0 || byte == b1 || byte == b2;
+  }
+};
+
+size_t NextByteScalar(const uint8_t *data, size_t from, size_t size,
+                      const Needles &needles) {
+  for (size_t i = from; i < size; ++i) {
+    if (needles.Contains(data[i]))
+      return i;
+  }
+  return size;
+}
+
+size_t PrevByteScalar(const uint8_t *data, size_t end, const Needles &needles) {
+  for (size_t i = end; i-- > 0;) {
+    if (needles.Contains(data[i]))
+      return i;
+  }
+  return SIZE_MAX;
+}
+
+// First position at or after from where the whole literal occurs
+size_t NextLiteralScalar(const uint8_t *data, size_t from, size_t size,
+                         std::span<const uint8_t> literal) {
+  if (size < literal.size())
+    return size;
+
+  for (size_t i = from; i + literal.size() <= size; ++i) {
+    if (data[i] == literal.front() &&
+        std::memcmp(data + i, literal.data(), literal.size()) == 0)
+      return i;
+  }
+  return size;
+}
+
+#ifdef REGEX_PREFILTER_X86
+
+size_t NextByteSse2(const uint8_t *data, size_t from, size_t size,
+                    const Needles &needles) {
+  const __m128i v0 = _mm_set1_epi8(static_cast<char>(needles.b0));
+  const __m128i v1 = _mm_set1_epi8(static_cast<char>(needles.b1));
+  const __m128i v2 = _mm_set1_epi8(static_cast<char>(needles.b2));
+
+  size_t i = from;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    const __m128i eq = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, v0), _mm_cmpeq_epi8(chunk, v1)),
+        _mm_cmpeq_epi8(chunk, v2));
+    const uint32_t mask = _mm_movemask_epi8(eq);
+
+    if (mask)
+      return i + __builtin_ctz(mask);
+  }
+
+  return NextByteScalar(data, i, size, needles);
+}
+
+size_t PrevByteSse2(const uint8_t *data, size_t end, const Needles &needles) {
+  const __m128i v0 = _mm_set1_epi8(static_cast<char>(needles.b0));
+  const __m128i v1 = _mm_set1_epi8(static_cast<char>(needles.b1));
+  const __m128i v2 = _mm_set1_epi8(static_cast<char>(needles.b2));
+
+  size_t i = end;
+  for (; i >= 16; i -= 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i - 16));
+    const __m128i eq = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, v0), _mm_cmpeq_epi8(chunk, v1)),
+        _mm_cmpeq_epi8(chunk, v2));
+    const uint32_t mask = _mm_movemask_epi8(eq);
+
+    if (mask)
+      return i - 16 + (31 - __builtin_clz(mask));
+  }
+
+  return PrevByteScalar(data, i, needles);
+}
+
+// Compare the first and last byte of the literal 16 positions at a time and
+// only verify the rest where both agree
+size_t NextLiteralSse2(const uint8_t *data, size_t from, size_t size,
+                       std::span<const uint8_t> literal) {
+  const size_t len = literal.size();
+  const __m128i first = _mm_set1_epi8(static_cast<char>(literal.front()));
+  const __m128i last = _mm_set1_epi8(static_cast<char>(literal.back()));
+
+  size_t i = from;
+  for (; i + len - 1 + 16 <= size; i += 16) {
+    const __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    const __m128i block_last =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + len - 1));
+    uint32_t mask = _mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+
+    while (mask) {
+      const size_t candidate = i + __builtin_ctz(mask);
+      if (std::memcmp(data + candidate + 1, literal.data() + 1, len - 2) == 0)
+        return candidate;
+      mask &= mask - 1;
+    }
+  }
+
+  return NextLiteralScalar(data, i, size, literal);
+}
+
+__attribute__((target("avx2"))) size_t
+NextByteAvx2(const uint8_t *data, size_t from, size_t size,
+             const Needles &needles) {
+  const __m256i v0 = _mm256_set1_epi8(static_cast<char>(needles.b0));
+  const __m256i v1 = _mm256_set1_epi8(static_cast<char>(needles.b1));
+  const __m256i v2 = _mm256_set1_epi8(static_cast<char>(needles.b2));
+
+  size_t i = from;
+  for (; i + 32 <= size; i += 32) {
+    const __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    const __m256i eq = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, v0),
+                        _mm256_cmpeq_epi8(chunk, v1)),
+        _mm256_cmpeq_epi8(chunk, v2));
+    const uint32_t mask = _mm256_movemask_epi8(eq);
+
+    if (mask)
+      return i + __builtin_ctz(mask);
+  }
+
+  return NextByteSse2(data, i, size, needles);
+}
+
+__attribute__((target("avx2"))) size_t
+NextLiteralAvx2(const uint8_t *data, size_t from, size_t size,
+                std::span<const uint8_t> literal) {
+  const size_t len = literal.size();
+  const __m256i first = _mm256_set1_epi8(static_cast<char>(literal.front()));
+  const __m256i last = _mm256_set1_epi8(static_cast<char>(literal.back()));
+
+  size_t i = from;
+  for (; i + len - 1 + 32 <= size; i += 32) {
+    const __m256i block_first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    const __m256i block_last = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(data + i + len - 1));
+    uint32_t mask = _mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+                         _mm256_cmpeq_epi8(block_last, last)));
+
+    while (mask) {
+      const size_t candidate = i + __builtin_ctz(mask);
+      if (std::memcmp(data + candidate + 1, literal.data() + 1, len - 2) == 0)
+        return candidate;
+      mask &= mask - 1;
+    }
+  }
+
+  return NextLiteralSse2(data, i, size, literal);
+}
+
+// Checked on first use rather than during static initialization, where
+// another translation unit's initializer could search before it is set
+bool HasAvx2() {
+  static const bool avx2 =
+      (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+  return avx2;
+}
+
+#endif
+
+} // namespace
+
+/*
+ * Walk the subsets of the NFA from the start: the labels leaving the start
+ * subset are the first bytes. For as long as a subset doesn't accept and has
+ * only one label leaving it, that label is also part of the literal prefix.
+ */
+Prefilter::Prefilter(const FSA &fsa) {
+  if (fsa.Empty())
+    return;
+
+  const FSA::Closures closures = fsa.EpsilonClosures();
+
+  std::vector<uint64_t> subset(closures[fsa.StartState()].begin(),
+                               closures[fsa.StartState()].end());
+  std::vector<uint8_t> prefix;
+  std::vector<int64_t> labels;
+
+  while (prefix.size() < MaxLiteral) {
+    labels.clear();
+    bool accepts{false};
+
+    for (uint64_t state : subset) {
+      accepts = accepts || fsa.IsAcceptState(state);
+      for (const FSA::Transition &trans : fsa.TransitionsFrom(state)) {
+        if (FSA::IsEpsilon(trans.label))
+          continue;
+        for (int64_t byte = trans.label; byte <= trans.hi; ++byte)
+          labels.push_back(byte);
+      }
+    }
+
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+    if (prefix.empty()) {
+      // Empty matches can start anywhere
+      if (accepts || labels.empty() || labels.size() > MaxBytes)
+        return;
+      bytes.assign(labels.begin(), labels.end());
+    }
+
+    if (accepts || labels.size() != 1)
+      break;
+
+    prefix.push_back(static_cast<uint8_t>(labels.front()));
+
+    std::vector<uint64_t> next;
+    for (uint64_t state : subset) {
+      for (const FSA::Transition &trans : fsa.TransitionsFrom(state)) {
+        if (trans.Covers(labels.front()))
+          next.insert(next.end(), closures[trans.to].begin(),
+                      closures[trans.to].end());
+      }
+    }
+    std::sort(next.begin(), next.end());
+    next.erase(std::unique(next.begin(), next.end()), next.end());
+    subset = std::move(next);
+  }
+
+  if (prefix.size() >= 2)
+    literal = std::move(prefix);
+}
+
+size_t Prefilter::Next(std::span<const uint8_t> input, size_t from) const {
+  if (!Active())
+    return from;
+
+#ifdef REGEX_PREFILTER_X86
+  if (!literal.empty()) {
+    return HasAvx2()
+               ? NextLiteralAvx2(input.data(), from, input.size(), literal)
+               : NextLiteralSse2(input.data(), from, input.size(), literal);
+  }
+
+  const Needles needles(bytes);
+  return HasAvx2() ? NextByteAvx2(input.data(), from, input.size(), needles)
+                   : NextByteSse2(input.data(), from, input.size(), needles);
+#else
+  if (!literal.empty())
+    return NextLiteralScalar(input.data(), from, input.size(), literal);
+
+  return NextByteScalar(input.data(), from, input.size(), Needles(bytes));
+#endif
+}
+
+size_t Prefilter::Prev(std::span<const uint8_t> input, size_t lo,
+                       size_t end) const {
+  if (end <= lo)
+    return SIZE_MAX;
+
+  if (!Active())
+    return end - 1;
+
+#ifdef REGEX_PREFILTER_X86
+  const size_t found =
+      PrevByteSse2(input.data() + lo, end - lo, Needles(bytes));
+#else
+  const size_t found =
+      PrevByteScalar(input.data() + lo, end - lo, Needles(bytes));
+#endif
+
+  return found == SIZE_MAX ? SIZE_MAX : lo + found;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "FSA.hpp"
+
+/*
+ * Cheap test for where a match of a pattern could start, used to skip over
+ * input while an unanchored DFA is idle in its start state. The FSA is
+ * analyzed for the set of bytes every match has to start with and, if every
+ * match starts with the same few bytes, that literal prefix. Scanning for
+ * either uses SSE2 (or AVX2 when the CPU has it) to look at 16 (32) bytes at a
+ * time, memchr style.
+ *
+ * Patterns that can match the empty string, or can start with too many
+ * different bytes for the scan to pay off, get an inactive prefilter that
+ * accepts every position.
+ */
+class Prefilter {
+public:
+  static constexpr uint64_t MaxBytes{3};
+  static constexpr uint64_t MaxLiteral{16};
+
+private:
+  // Every possible first byte of a match, empty if inactive
+  std::vector<uint8_t> bytes{};
+  // Prefix shared by every match, only used when at least two bytes long
+  std::vector<uint8_t> literal{};
+
+public:
+  // Inactive
+  Prefilter() = default;
+
+  explicit Prefilter(const FSA &fsa);
+
+  bool Active() const { return !bytes.empty(); }
+
+  std::span<const uint8_t> Bytes() const { return bytes; }
+
+  std::span<const uint8_t> Literal() const { return literal; }
+
+  // First position at or after from where a match could start, or
+  // input.size() if there is none
+  size_t Next(std::span<const uint8_t> input, size_t from) const;
+
+  // Last position in [lo, end) holding one of the first bytes, or SIZE_MAX if
+  // there is none. Only looks at single bytes, never the literal
+  size_t Prev(std::span<const uint8_t> input, size_t lo, size_t end) const;
+};
@@ -1,26 +1,306 @@
 #include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "DFA.hpp"
+#include "DFAFile.hpp"
 #include "FSA.hpp"
 #include "LangFrontend.hpp"
+#include "LazyDFA.hpp"
+#include "MatchState.hpp"
+#include "NFASimulator.hpp"
+#include "Parallel.hpp"
+#include "Search.hpp"
+#include "Stats.hpp"
+#include "TaggedDFA.hpp"
 #include "Regex.hpp"
 
 namespace Regex {
 
-Matcher::Matcher(std::string_view expression) {
-  Lexer lex(expression);
-  std::vector<Token> toks = lex.Lex();
-  Parser parser(toks);
-  fsa = parser.Parse();
-  fsa.Determinize();
-  fsa.Minimize();
+namespace {
+
+// Batches are split into pieces of this many inputs across threads
+constexpr uint64_t BatchGrain{4096};
+
+std::span<const uint8_t> Bytes(std::string_view str) {
+  return {reinterpret_cast<const uint8_t *>(str.data()), str.size()};
+}
+
+} // namespace
+
+Matcher::Matcher(std::string_view expression, Engine engine)
+    : engine(engine), expression(expression) {
+  CompileStats &compile = stats.compile;
+
+  {
+    StatsTimer timer(&compile.parse_ns);
+    Lexer lex(expression);
+    std::vector<Token> toks = lex.Lex();
+    Parser parser(toks);
+    fsa = parser.Parse();
+    n_groups = parser.NumGroups() + 1;
+  }
+
+  if constexpr (StatsEnabled) {
+    compile.nfa_states = fsa.NumStates();
+    compile.nfa_transitions = fsa.NumTransitions();
+    compile.nfa_bytes = fsa.MemoryUsage();
+  }
+
+  switch (engine) {
+  case Engine::Dfa:
+    fsa.Determinize(&compile);
+    if constexpr (StatsEnabled) {
+      compile.dfa_states = fsa.NumStates();
+      compile.dfa_transitions = fsa.NumTransitions();
+    }
+
+    {
+      StatsTimer timer(&compile.minimize_ns);
+      fsa.Minimize(&compile);
+    }
+    if constexpr (StatsEnabled) {
+      compile.min_states = fsa.NumStates();
+      compile.min_transitions = fsa.NumTransitions();
+    }
+
+    {
+      StatsTimer timer(&compile.table_ns);
+      dfa = DFA(fsa);
+    }
+    if constexpr (StatsEnabled)
+      compile.table_bytes = dfa.MemoryUsage();
+    break;
+  case Engine::LazyDfa:
+    lazy_dfa.emplace(fsa);
+    break;
+  case Engine::Nfa:
+    nfa_simulator.emplace(fsa);
+    break;
+  }
 }
 
-bool Matcher::Match(std::string_view str) {
-	std::vector<int64_t> chars(str.begin(), str.end());
-	return fsa.ConsumeString(chars);
+bool Matcher::Match(std::string_view str) { return Match(Bytes(str)); }
+
+bool Matcher::Match(std::span<const uint8_t> str) {
+  if constexpr (StatsEnabled) {
+    if (collect_match_stats)
+      return TracedMatch(str);
+  }
+
+  switch (engine) {
+  case Engine::Dfa:
+    return dfa.Match(str);
+  case Engine::LazyDfa:
+    return lazy_dfa->Match(str);
+  case Engine::Nfa:
+    return nfa_simulator->Match(str);
+  }
+
+  assert(false);
+  return false;
 }
 
+bool Matcher::TracedMatch(std::span<const uint8_t> str) {
+  MatchTrace trace;
+  bool matched{false};
+
+  switch (engine) {
+  case Engine::Dfa:
+    matched = dfa.IsAcceptState(dfa.Run(str, trace));
+    break;
+  case Engine::LazyDfa:
+    matched = lazy_dfa->Match(str, trace);
+    break;
+  case Engine::Nfa:
+    matched = nfa_simulator->Match(str, trace);
+    break;
+  }
+
+  ++stats.match.matches;
+  stats.match.steps += trace.steps;
+  stats.match.dead_exits += trace.dead;
+
+  return matched;
+}
+
+MatchState Matcher::Stream() {
+  if (engine == Engine::Dfa)
+    return MatchState(dfa);
+
+  if (!stream_dfa) {
+    FSA determinized = fsa;
+    determinized.Determinize();
+    determinized.Minimize();
+    stream_dfa.emplace(determinized);
+  }
+
+  return MatchState(*stream_dfa);
+}
+
+void Matcher::MatchBatch(std::span<const std::string_view> inputs,
+                         std::span<bool> results) {
+  assert(results.size() >= inputs.size());
+
+  if (engine != Engine::Dfa) {
+    for (uint64_t i = 0; i < inputs.size(); ++i)
+      results[i] = Match(inputs[i]);
+    return;
+  }
+
+  if (inputs.size() <= BatchGrain) {
+    dfa.MatchBatch(inputs, results);
+    return;
+  }
+
+  tbb::parallel_for(
+      tbb::blocked_range<uint64_t>(0, inputs.size(), BatchGrain),
+      [&](const tbb::blocked_range<uint64_t> &range) {
+        dfa.MatchBatch(inputs.subspan(range.begin(), range.size()),
+                       results.subspan(range.begin(), range.size()));
+      });
+}
+
+bool Matcher::ParallelMatch(std::string_view str, uint64_t chunk_size) {
+  if (engine != Engine::Dfa || str.size() <= chunk_size)
+    return Match(str);
+
+  return dfa.IsAcceptState(Parallel::Run(dfa, Bytes(str), chunk_size));
+}
+
+const Searcher &Matcher::GetSearcher() {
+  if (!searcher)
+    searcher.emplace(fsa);
+
+  return *searcher;
+}
+
+std::optional<MatchSpan> Matcher::Find(std::string_view str) {
+  return GetSearcher().Find(Bytes(str));
+}
 
+TaggedDFA &Matcher::GetTaggedDfa() {
+  if (!tagged_dfa) {
+    // The plain FSA has no tags, so parse again with them
+    Lexer lex(expression);
+    Parser parser(lex.Lex(), true);
+    tagged_dfa.emplace(parser.Parse(), 2 * (n_groups - 1));
+    tag_values.resize(tagged_dfa->NumTags());
+  }
+
+  return *tagged_dfa;
+}
+
+bool Matcher::Match(std::string_view str,
+                    std::span<std::optional<MatchSpan>> groups) {
+  assert(groups.size() >= n_groups);
+
+  if (!GetTaggedDfa().Match(str, tag_values))
+    return false;
+
+  groups[0] = MatchSpan{0, str.size()};
+  for (uint64_t group = 1; group < n_groups; ++group) {
+    const size_t begin = tag_values[2 * (group - 1)];
+    const size_t end = tag_values[2 * (group - 1) + 1];
+
+    if (begin == TaggedDFA::NoPosition || end == TaggedDFA::NoPosition)
+      groups[group] = std::nullopt;
+    else
+      groups[group] = MatchSpan{begin, end};
+  }
+
+  return true;
+}
+
+std::optional<MatchSpan>
+Matcher::Find(std::string_view str,
+              std::span<std::optional<MatchSpan>> groups) {
+  std::optional<MatchSpan> found = Find(str);
+  if (!found)
+    return std::nullopt;
+
+  // Groups come out relative to the match
+  Match(str.substr(found->begin, found->end - found->begin), groups);
+  for (uint64_t group = 0; group < n_groups; ++group) {
+    if (groups[group]) {
+      groups[group]->begin += found->begin;
+      groups[group]->end += found->begin;
+    }
+  }
+
+  return found;
+}
+
+std::vector<MatchSpan> Matcher::FindAll(std::string_view str) {
+  if constexpr (StatsEnabled) {
+    if (collect_match_stats)
+      return TracedFindAll(Bytes(str));
+  }
+
+  return GetSearcher().FindAll(Bytes(str));
+}
+
+std::vector<MatchSpan> Matcher::TracedFindAll(std::span<const uint8_t> str) {
+  std::vector<MatchSpan> res;
+  MatchIterator it = GetSearcher().Matches(str).begin();
+  for (; it != std::default_sentinel; ++it)
+    res.push_back(*it);
+
+  ++stats.match.matches;
+  stats.match.steps += it.Steps();
+
+  return res;
+}
+
+std::vector<MatchSpan> Matcher::ParallelFindAll(std::string_view str,
+                                                uint64_t chunk_size) {
+  if (str.size() <= chunk_size)
+    return FindAll(str);
+
+  return GetSearcher().ParallelFindAll(Bytes(str), chunk_size);
+}
+
+std::ranges::subrange<MatchIterator, std::default_sentinel_t>
+Matcher::Matches(std::string_view str) {
+  return GetSearcher().Matches(Bytes(str));
+}
+
+void Matcher::Save(std::ostream &out) const {
+  if (engine == Engine::Dfa) {
+    dfa.Serialize(out);
+    return;
+  }
+
+  FSA determinized = fsa;
+  determinized.Determinize();
+  determinized.Minimize();
+  DFA(determinized).Serialize(out);
+}
+
+MappedMatcher::MappedMatcher(const std::string &path)
+    : file(path), dfa(file.Bytes()) {}
+
+bool MappedMatcher::Match(std::string_view str) const {
+  return Match(Bytes(str));
+}
+
+bool MappedMatcher::Match(std::span<const uint8_t> str) const {
+  return dfa.Match(str);
+}
+
+std::span<const uint64_t>
+MappedMatcher::MatchPatterns(std::string_view str) const {
+  return dfa.AcceptTags(dfa.Run(Bytes(str)));
+}
 
 } // namespace Regex
@@ -1,30 +1,204 @@
 #pragma once
 
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DFA.hpp"
+#include "DFAFile.hpp"
 #include "FSA.hpp"
+#include "LangFrontend.hpp"
+#include "LazyDFA.hpp"
+#include "MatchState.hpp"
+#include "NFASimulator.hpp"
+#include "Parallel.hpp"
+#include "Search.hpp"
+#include "Stats.hpp"
+#include "TaggedDFA.hpp"
 
 namespace Regex {
 
-struct ParseError {};
+enum class Engine {
+  // Determinize and minimize up front, match with a dense table
+  Dfa,
+  // Build DFA states only as the input reaches them, in a bounded cache
+  LazyDfa,
+  // Skip determinization and simulate the NFA, O(n * m) worst case
+  Nfa,
+};
+
+struct MatcherStats {
+  CompileStats compile{};
+  MatchStats match{};
+};
 
 class Matcher {
 private:
+  Engine engine;
+  std::string expression;
+  // Including group 0, the whole match
+  uint64_t n_groups;
   FSA fsa;
+  DFA dfa;
+  std::optional<LazyDFA> lazy_dfa;
+  std::optional<NFASimulator> nfa_simulator;
+  // Only built the first time something is searched for
+  std::optional<Searcher> searcher;
+  // Full DFA for engines that don't build one up front, only built the
+  // first time a stream is started
+  std::optional<DFA> stream_dfa;
+  // Only built the first time captures are asked for, with tag_values
+  // holding its output
+  std::optional<TaggedDFA> tagged_dfa;
+  std::vector<size_t> tag_values;
+
+  MatcherStats stats{};
+  bool collect_match_stats{false};
+
+  const Searcher &GetSearcher();
+
+  // Match and FindAll, counting into stats.match
+  bool TracedMatch(std::span<const uint8_t>);
+  std::vector<MatchSpan> TracedFindAll(std::span<const uint8_t>);
+
+  TaggedDFA &GetTaggedDfa();
 
 public:
   /*
    * Ctor. May throw a ParseError
    */
-  Matcher(std::string_view expression);
+  Matcher(std::string_view expression, Engine engine = Engine::Dfa);
 
   /*
-   * Check if the input string is in the language
+   * Check if the input string is in the language. Neither overload copies the
+   * input or allocates, except while the lazy DFA's cache is still filling up
    */
   bool Match(std::string_view);
 
+  bool Match(std::span<const uint8_t>);
+
+  /*
+   * What compiling has cost, and what matching has since match stats were
+   * turned on. Everything stays zero if built with REGEX_STATS=0
+   */
+  const MatcherStats &Stats() const { return stats; }
+
+  /*
+   * Start or stop counting calls to Match (without groups) and FindAll into
+   * Stats().match. Off by default
+   */
+  void CollectMatchStats(bool on) { collect_match_stats = on; }
+
+  /*
+   * Number of capture groups, counting group 0 (the whole match) and then
+   * every parenthesized group in order of its opening parenthesis
+   */
+  uint64_t NumGroups() const { return n_groups; }
+
+  /*
+   * Match, also storing what each group matched in groups, which must hold
+   * NumGroups() spans. Groups that took no part in the match are nullopt, and
+   * groups in a star hold their last iteration. Ambiguities go the way a
+   * backtracking matcher would resolve them: leftmost alternative first, and
+   * stars as greedy as possible. Runs a tagged DFA, so it stays linear time
+   * and doesn't allocate once the tagged DFA is built
+   */
+  bool Match(std::string_view, std::span<std::optional<MatchSpan>> groups);
+
+  /*
+   * Resumable match over input fed in pieces, see MatchState. The matcher must
+   * outlive it
+   */
+  MatchState Stream();
+
+  /*
+   * Match every input, storing the results in the same order. With the Dfa
+   * engine several inputs are walked at once, and large batches are spread
+   * over every core
+   */
+  void MatchBatch(std::span<const std::string_view>, std::span<bool>);
+
+  /*
+   * Same as Match, with the input scanned in chunks of about chunk_size bytes
+   * on every core. Only the Dfa engine splits the input; the others match it
+   * in one piece
+   */
+  bool ParallelMatch(std::string_view,
+                     uint64_t chunk_size = Parallel::DefaultChunkSize);
+
+  /*
+   * Leftmost-longest substring in the language, if there is one
+   */
+  std::optional<MatchSpan> Find(std::string_view);
+
+  /*
+   * Find, also storing what each group matched within the match as for Match
+   */
+  std::optional<MatchSpan> Find(std::string_view,
+                                std::span<std::optional<MatchSpan>> groups);
+
+  /*
+   * All non-overlapping leftmost-longest substrings in the language
+   */
+  std::vector<MatchSpan> FindAll(std::string_view);
+
+  /*
+   * Same as FindAll, with match starts found in chunks of about chunk_size
+   * bytes on every core
+   */
+  std::vector<MatchSpan>
+  ParallelFindAll(std::string_view,
+                  uint64_t chunk_size = Parallel::DefaultChunkSize);
+
+  /*
+   * Range of the same matches as FindAll, found as the range is walked. The
+   * string must outlive the range
+   */
+  std::ranges::subrange<MatchIterator, std::default_sentinel_t>
+  Matches(std::string_view);
+
+  /*
+   * Write the compiled DFA for MappedMatcher to load, determinizing first if
+   * another engine was picked
+   */
+  void Save(std::ostream &) const;
+
   inline void PrintFsa() {
 	  std::cout << fsa;
   }
 
 };
 
+/*
+ * Matcher over a file written by Matcher::Save or PatternSet::Save, mapped
+ * read-only and matched against in place. Loading skips lexing, parsing and
+ * determinization entirely, and processes mapping the same file share it
+ */
+class MappedMatcher {
+private:
+  MappedFile file;
+  DFAView dfa;
+
+public:
+  /*
+   * Ctor. May throw a DFAFileError
+   */
+  explicit MappedMatcher(const std::string &path);
+
+  bool Match(std::string_view) const;
+
+  bool Match(std::span<const uint8_t>) const;
+
+  /*
+   * Indices of the matching patterns, for files written by a PatternSet
+   */
+  std::span<const uint64_t> MatchPatterns(std::string_view) const;
+};
+
 } // namespace Regex
@@ -0,0 +1,378 @@
+#include "Search.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+#include "Parallel.hpp"
+
+namespace {
+
+// .*, over every byte
+FSA AnyString() {
+  FSA fsa;
+  fsa.AddStates(1);
+  for (int64_t byte = 0; byte < static_cast<int64_t>(DFA::AlphabetSize);
+       ++byte)
+    fsa.AddTransition(0, 0, byte);
+  fsa.AcceptState(0);
+  return fsa;
+}
+
+DFA Compile(FSA fsa) {
+  fsa.Determinize();
+  fsa.Minimize();
+  return DFA(fsa);
+}
+
+bool Test(const std::vector<uint64_t> &bits, size_t i) {
+  return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+// First set bit of bits at or after i, or SIZE_MAX if there is none
+size_t NextSet(const std::vector<uint64_t> &bits, size_t i) {
+  size_t word = i / 64;
+  if (word >= bits.size())
+    return SIZE_MAX;
+
+  uint64_t rest = bits[word] & (~uint64_t{0} << (i % 64));
+  while (rest == 0) {
+    if (++word == bits.size())
+      return SIZE_MAX;
+    rest = bits[word];
+  }
+
+  return word * 64 + std::countr_zero(rest);
+}
+
+} // namespace
+
+Searcher::Searcher(const FSA &fsa) {
+  // Nothing can match, leave every DFA dead
+  if (fsa.Empty())
+    return;
+
+  reverse = Compile(FSA::Concatenate(AnyString(), FSA::Reverse(fsa)));
+  anchored = Compile(fsa);
+  forward_prefilter = Prefilter(fsa);
+  reverse_prefilter = Prefilter(FSA::Reverse(fsa));
+}
+
+void Searcher::ReverseScan(std::span<const uint8_t> input, size_t lo,
+                           size_t hi, uint32_t &state,
+                           std::vector<uint64_t> &starts) const {
+  const uint32_t start = reverse.StartState();
+
+  for (size_t i = hi; i > lo;) {
+    // Nothing but the start state's own bytes can leave the start state
+    if (state == start && reverse_prefilter.Active()) {
+      i = reverse_prefilter.Prev(input, lo, i);
+      if (i == SIZE_MAX)
+        break;
+    } else {
+      --i;
+    }
+
+    state = reverse.Next(state, input[i]);
+
+    if (reverse.IsAcceptState(state))
+      starts[i / 64] |= uint64_t{1} << (i % 64);
+  }
+}
+
+/*
+ * One run per candidate start, each in its own thread. A thread that reaches
+ * a state another thread already holds is merged into it: from there on its
+ * run is the other one's, so its longest match ends where the other one last
+ * accepts, if that's at or after the merge, and otherwise where it last
+ * accepted on its own. Threads only merge into earlier ones, which are
+ * resolved first. Once the window is full no more threads start, and the ones
+ * left are followed until they die or the input ends.
+ */
+size_t Searcher::LongestMatches(std::span<const uint8_t> input, size_t from,
+                                const std::vector<uint64_t> *starts,
+                                std::vector<MatchSpan> &window,
+                                uint64_t &steps) const {
+  constexpr uint32_t NoThread{UINT32_MAX};
+  constexpr size_t NoEnd{SIZE_MAX};
+
+  struct Thread {
+    uint32_t state;
+    uint32_t id;
+  };
+
+  window.clear();
+  const uint32_t start = anchored.StartState();
+  if (start == DFA::Dead)
+    return input.size() + 1;
+
+  // Per thread, its match so far (end NoEnd if none), and what it merged
+  // into and where
+  std::vector<uint32_t> merged_into;
+  std::vector<size_t> merged_at;
+
+  // Live threads in order of their start, and which one holds each state
+  std::vector<Thread> threads;
+  std::vector<Thread> advanced;
+  std::vector<uint32_t> owner(anchored.NumStates(), NoThread);
+
+  size_t i = from;
+  size_t resume = input.size() + 1;
+  bool starting = true;
+
+  while (true) {
+    if (starting && threads.empty()) {
+      // Skip straight to the next candidate
+      if (starts)
+        i = NextSet(*starts, i);
+      else if (forward_prefilter.Active())
+        i = forward_prefilter.Next(input, i);
+
+      // An active prefilter means no match is empty, so none starts at the end
+      if (i > input.size() ||
+          (!starts && forward_prefilter.Active() && i == input.size()))
+        break;
+    }
+
+    if (starting && (!starts || Test(*starts, i))) {
+      threads.push_back({start, static_cast<uint32_t>(window.size())});
+      window.push_back({i, anchored.IsAcceptState(start) ? i : NoEnd});
+      merged_into.push_back(NoThread);
+      merged_at.push_back(0);
+
+      if (window.size() == Window) {
+        starting = false;
+        resume = i + 1;
+      }
+    }
+
+    if (i == input.size() || (!starting && threads.empty()))
+      break;
+
+    steps += threads.size();
+    advanced.clear();
+    for (const Thread &thread : threads) {
+      const uint32_t state = anchored.Next(thread.state, input[i]);
+      if (state == DFA::Dead)
+        continue;
+
+      if (owner[state] != NoThread) {
+        merged_into[thread.id] = owner[state];
+        merged_at[thread.id] = i + 1;
+        continue;
+      }
+
+      owner[state] = thread.id;
+      advanced.push_back({state, thread.id});
+      if (anchored.IsAcceptState(state))
+        window[thread.id].end = i + 1;
+    }
+
+    for (const Thread &thread : advanced)
+      owner[thread.state] = NoThread;
+    std::swap(threads, advanced);
+    ++i;
+  }
+
+  for (size_t id = 0; id < window.size(); ++id) {
+    const uint32_t into = merged_into[id];
+    if (into != NoThread && window[into].end != NoEnd &&
+        window[into].end >= merged_at[id])
+      window[id].end = window[into].end;
+  }
+
+  // Only the candidates that matched are match starts
+  std::erase_if(window, [](const MatchSpan &match) {
+    return match.end == NoEnd;
+  });
+
+  return resume;
+}
+
+/*
+ * Same threads as LongestMatches, but only until the leftmost match is known:
+ * no thread starts once one has matched, threads from later starts than the
+ * one that matched are dropped, and the search is over when every thread left
+ * has died. A thread from an earlier start that matches later still wins.
+ */
+std::optional<MatchSpan> Searcher::Find(std::span<const uint8_t> input,
+                                        size_t from) const {
+  struct Thread {
+    uint32_t state;
+    size_t begin;
+  };
+
+  const uint32_t start = anchored.StartState();
+  if (from > input.size() || start == DFA::Dead)
+    return std::nullopt;
+
+  std::optional<MatchSpan> best;
+  std::vector<Thread> threads;
+  std::vector<Thread> advanced;
+  std::vector<bool> held(anchored.NumStates(), false);
+
+  for (size_t i = from;; ++i) {
+    if (!best) {
+      if (threads.empty() && forward_prefilter.Active()) {
+        i = forward_prefilter.Next(input, i);
+        if (i == input.size())
+          break;
+      }
+
+      threads.push_back({start, i});
+      if (anchored.IsAcceptState(start))
+        best = MatchSpan{i, i};
+    }
+
+    if (i == input.size() || threads.empty())
+      break;
+
+    advanced.clear();
+    for (const Thread &thread : threads) {
+      if (best && thread.begin > best->begin)
+        break;
+
+      const uint32_t state = anchored.Next(thread.state, input[i]);
+      if (state == DFA::Dead || held[state])
+        continue;
+
+      held[state] = true;
+      advanced.push_back({state, thread.begin});
+      if (anchored.IsAcceptState(state))
+        best = MatchSpan{thread.begin, i + 1};
+    }
+
+    for (const Thread &thread : advanced)
+      held[thread.state] = false;
+    std::swap(threads, advanced);
+  }
+
+  return best;
+}
+
+std::vector<MatchSpan>
+Searcher::FindAll(std::span<const uint8_t> input) const {
+  std::vector<MatchSpan> res;
+  for (const MatchSpan &match : Matches(input))
+    res.push_back(match);
+  return res;
+}
+
+/*
+ * Only finding the starts is split up. Every chunk is scanned at once on the
+ * guess that reverse enters it in its start state, which holds unless a match
+ * crosses into it from the right. Chunks are then checked from the right:
+ * where the guess was wrong, the chunk is rescanned from the right state until
+ * that run reaches the start state too. Since reverse is a DFA for .*X, whose
+ * every state contains the start state's NFA subset, a run from any state that
+ * lands in the start state lands where the guessed run is at the same point,
+ * and the two agree from there on. Starts only found by the rescan are added
+ * to the bitmap; the guessed run's are all real.
+ */
+std::vector<MatchSpan>
+Searcher::ParallelFindAll(std::span<const uint8_t> input,
+                          uint64_t chunk_size) const {
+  chunk_size = Parallel::ChunkSize(chunk_size);
+  const uint64_t n_chunks = Parallel::NumChunks(input.size(), chunk_size);
+  const uint32_t start = reverse.StartState();
+
+  auto bounds = [&](uint64_t k) {
+    return std::pair<size_t, size_t>(
+        k * chunk_size, std::min<size_t>((k + 1) * chunk_size, input.size()));
+  };
+
+  std::vector<uint64_t> starts(input.size() / 64 + 1, 0);
+  if (reverse.IsAcceptState(start))
+    starts[input.size() / 64] |= uint64_t{1} << (input.size() % 64);
+
+  // Chunks own whole words of starts, so they can mark them concurrently
+  std::vector<uint32_t> exits(n_chunks, start);
+  tbb::parallel_for(uint64_t{0}, n_chunks, [&](uint64_t k) {
+    const auto [lo, hi] = bounds(k);
+    ReverseScan(input, lo, hi, exits[k], starts);
+  });
+
+  uint32_t entry = start;
+  for (uint64_t k = n_chunks; k-- > 0;) {
+    if (entry == start) {
+      entry = exits[k];
+      continue;
+    }
+
+    const auto [lo, hi] = bounds(k);
+    uint32_t state = entry;
+    size_t i = hi;
+    for (; i > lo && state != start; --i) {
+      state = reverse.Next(state, input[i - 1]);
+      if (reverse.IsAcceptState(state))
+        starts[(i - 1) / 64] |= uint64_t{1} << ((i - 1) % 64);
+    }
+
+    entry = state == start ? exits[k] : state;
+  }
+
+  std::vector<MatchSpan> res;
+  MatchIterator it(*this, input, &starts);
+  for (; it != std::default_sentinel; ++it)
+    res.push_back(*it);
+  return res;
+}
+
+std::ranges::subrange<MatchIterator, std::default_sentinel_t>
+Searcher::Matches(std::span<const uint8_t> input) const {
+  return {MatchIterator(*this, input), std::default_sentinel};
+}
+
+MatchIterator::MatchIterator(const Searcher &searcher,
+                             std::span<const uint8_t> input)
+    : MatchIterator(searcher, input, nullptr) {}
+
+MatchIterator::MatchIterator(const Searcher &searcher,
+                             std::span<const uint8_t> input,
+                             const std::vector<uint64_t> *starts)
+    : searcher(&searcher), input(input), starts(starts) {
+  Advance();
+}
+
+void MatchIterator::Advance() {
+  current.reset();
+
+  while (true) {
+    for (; next < window.size(); ++next) {
+      const MatchSpan &match = window[next];
+
+      // Starts inside the last match are taken
+      if (last_end && match.begin < *last_end)
+        continue;
+
+      // An empty match right where the last one ended doesn't count
+      if (match.end == match.begin && last_end == match.begin)
+        continue;
+
+      current = match;
+      last_end = match.end;
+      ++next;
+      return;
+    }
+
+    if (position > input.size())
+      return;
+
+    // No need to follow starts inside the last match at all
+    if (last_end && *last_end > position)
+      position = *last_end;
+
+    position =
+        searcher->LongestMatches(input, position, starts, window, steps);
+    next = 0;
+  }
+}
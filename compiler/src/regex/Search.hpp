@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include "DFA.hpp"
+#include "FSA.hpp"
+#include "Prefilter.hpp"
+
+// Half open byte range [begin, end) of a match within the searched input
+struct MatchSpan {
+  size_t begin;
+  size_t end;
+
+  bool operator==(const MatchSpan &) const = default;
+};
+
+class Searcher;
+
+/*
+ * Input iterator over the non-overlapping matches in an input. Empty matches
+ * are reported too, except directly at the end of the previous match.
+ *
+ * Matches are found a window at a time as the iterator is advanced: the
+ * longest matches from the next Searcher::Window match starts, which is all
+ * the iterator holds however long the input is.
+ */
+class MatchIterator {
+private:
+  const Searcher *searcher{nullptr};
+  std::span<const uint8_t> input{};
+  // Match starts found beforehand, or null if every position is a candidate
+  const std::vector<uint64_t> *starts{nullptr};
+
+  // Where the next window starts, past input.size() once there is none
+  size_t position{0};
+  // The longest match from every match start in the window, left to right,
+  // and the next of them to consider
+  std::vector<MatchSpan> window{};
+  size_t next{0};
+
+  std::optional<size_t> last_end{};
+  std::optional<MatchSpan> current{};
+  uint64_t steps{0};
+
+  void Advance();
+
+  friend class Searcher;
+
+  // Over starts already computed for input, which must outlive the iterator
+  MatchIterator(const Searcher &searcher, std::span<const uint8_t> input,
+                const std::vector<uint64_t> *starts);
+
+public:
+  using value_type = MatchSpan;
+  using difference_type = std::ptrdiff_t;
+
+  MatchIterator() = default;
+
+  MatchIterator(const Searcher &searcher, std::span<const uint8_t> input);
+
+  const MatchSpan &operator*() const { return *current; }
+
+  const MatchSpan *operator->() const { return &*current; }
+
+  MatchIterator &operator++() {
+    Advance();
+    return *this;
+  }
+
+  void operator++(int) { Advance(); }
+
+  bool operator==(std::default_sentinel_t) const { return !current; }
+
+  // DFA transitions taken so far, one per byte for every run being followed
+  uint64_t Steps() const { return steps; }
+};
+
+/*
+ * Finds substrings of an input that are in the language, with leftmost-longest
+ * semantics: among the matches starting earliest, the longest one wins.
+ *
+ * Searching runs the pattern's DFA anchored from every position at once, left
+ * to right. Two runs that reach the same state at the same position go on
+ * identically, so only the one from the earlier start is followed, which
+ * leaves at most one run per state at any time. Every byte is thus stepped
+ * once per live state instead of retrying a whole-string match at every
+ * offset. While no run is live, a prefilter skips ahead to the next byte a
+ * match can start with.
+ *
+ * A run can go on far past the end of its match before it dies (a|a*b over a
+ * long run of a), and every start whose run merged into it has to wait for it.
+ * So that memory stays bounded, starts are taken a window at a time and each
+ * window is followed until its runs have died. That is linear as long as runs
+ * die within about a window of their start; otherwise every window pays for
+ * its runs' overrun again, which is still Window times less than following
+ * every start on its own.
+ *
+ * ParallelFindAll instead finds the match starts first with a DFA for
+ * .*reverse(R), run right to left in chunks.
+ */
+class Searcher {
+public:
+  // Most match starts followed at once while iterating
+  static constexpr uint64_t Window{4096};
+
+private:
+  DFA reverse;
+  DFA anchored;
+  Prefilter forward_prefilter;
+  Prefilter reverse_prefilter;
+
+  friend class MatchIterator;
+
+  // Runs reverse over input[lo, hi) from hi down, entering it in state and
+  // leaving state as the one after input[lo], marking every match start in
+  // starts
+  void ReverseScan(std::span<const uint8_t> input, size_t lo, size_t hi,
+                   uint32_t &state, std::vector<uint64_t> &starts) const;
+
+  /*
+   * Replaces window with the longest match from each of the first Window
+   * candidate starts at or after from, in order, and returns the position
+   * after the last candidate. Candidates are the positions in starts if given,
+   * and every position otherwise. Adds the DFA transitions taken to steps
+   */
+  size_t LongestMatches(std::span<const uint8_t> input, size_t from,
+                        const std::vector<uint64_t> *starts,
+                        std::vector<MatchSpan> &window,
+                        uint64_t &steps) const;
+
+public:
+  // Takes the pattern's FSA, determinized or not
+  explicit Searcher(const FSA &fsa);
+
+  // Leftmost-longest match starting at or after from. Only reads as far as
+  // the runs from before the match's start, and the match's own, go on
+  std::optional<MatchSpan> Find(std::span<const uint8_t> input,
+                                size_t from = 0) const;
+
+  // All non-overlapping matches, left to right
+  std::vector<MatchSpan> FindAll(std::span<const uint8_t> input) const;
+
+  // Same matches as FindAll. The input is split into chunks of about
+  // chunk_size bytes that are scanned for match starts in parallel
+  std::vector<MatchSpan> ParallelFindAll(std::span<const uint8_t> input,
+                                         uint64_t chunk_size) const;
+
+  // Same matches as FindAll, found as the range is walked, a window at a
+  // time. The input must outlive the range
+  std::ranges::subrange<MatchIterator, std::default_sentinel_t>
+  Matches(std::span<const uint8_t> input) const;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Set of integers in [0, capacity) with constant time insert, lookup and
+ * clear, iterated in insertion order (Briggs & Torczon). Nothing is allocated
+ * after construction.
+ */
+class SparseSet {
+private:
+  std::vector<uint64_t> dense;
+  std::vector<uint64_t> sparse;
+  uint64_t size{0};
+
+public:
+  explicit SparseSet(uint64_t capacity = 0)
+      : dense(capacity), sparse(capacity) {}
+
+  uint64_t Capacity() const { return dense.size(); }
+
+  uint64_t Size() const { return size; }
+
+  bool Empty() const { return size == 0; }
+
+  bool Contains(uint64_t value) const {
+    const uint64_t index = sparse[value];
+    return index < size && dense[index] == value;
+  }
+
+  // Returns false if the value was already there
+  bool Insert(uint64_t value) {
+    if (Contains(value))
+      return false;
+
+    dense[size] = value;
+    sparse[value] = size++;
+    return true;
+  }
+
+  void Clear() { size = 0; }
+
+  std::vector<uint64_t>::const_iterator begin() const { return dense.begin(); }
+
+  std::vector<uint64_t>::const_iterator end() const {
+    return dense.begin() + size;
+  }
+};
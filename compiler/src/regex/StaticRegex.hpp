@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "FSA.hpp"
+#include "LangFrontend.hpp"
+#include "NFABuilder.hpp"
+
+/*
+ * Regexes compiled by the C++ compiler. A pattern given as a template argument
+ * goes through the same Lexer and Parser as a Matcher's, then subset
+ * construction and minimization, all in constant evaluation, and what comes
+ * out is a table in read-only data. So there's nothing to do at startup, a
+ * bad pattern fails the build, and matching is a loop the optimizer sees all
+ * the way through, with the table's dimensions as constants:
+ *
+ *   using Hex = Regex::StaticMatcher<"0x[0-9a-fA-F]+">;
+ *   static_assert(Hex::Match("0xBEEF"));
+ *
+ * Only whole-input matching is supported. Every step of compiling is written
+ * for small patterns (subsets and partitions are looked up linearly), since
+ * the compiler's constant evaluation is far slower than running code and has
+ * step limits.
+ */
+namespace Regex {
+
+// A string literal as a template argument
+template <size_t N> struct FixedString {
+  char chars[N]{};
+
+  constexpr FixedString(const char (&str)[N]) { std::copy_n(str, N, chars); }
+
+  constexpr std::string_view View() const { return {chars, N - 1}; }
+};
+
+namespace Static {
+
+// Smallest unsigned type that holds every value up to max
+template <uint64_t Max>
+using UintFor = std::conditional_t<
+    Max <= UINT8_MAX, uint8_t,
+    std::conditional_t<Max <= UINT16_MAX, uint16_t,
+                       std::conditional_t<Max <= UINT32_MAX, uint32_t,
+                                          uint64_t>>>;
+
+struct Shape {
+  uint64_t states;
+  uint64_t classes;
+};
+
+/*
+ * Same layout as DFA: next states row-major by [state][byte class], with
+ * state 0 dead, but sized exactly and with states as narrow as they can be
+ */
+template <uint64_t States, uint64_t Classes> struct Table {
+  using State = UintFor<States - 1>;
+
+  std::array<uint8_t, 256> classes{};
+  std::array<State, States * Classes> next{};
+  std::array<bool, States> accepting{};
+  State start{0};
+};
+
+// The minimal DFA, in vectors while its size isn't known yet
+struct Automaton {
+  std::array<uint8_t, 256> classes{};
+  uint64_t n_classes{0};
+  uint64_t n_states{0};
+  std::vector<uint64_t> next{};
+  std::vector<bool> accepting{};
+  uint64_t start{0};
+};
+
+/*
+ * Parses pattern into an NFA, then determinizes over byte classes cut at the
+ * bounds of every range, and minimizes by refining the accepting/rejecting
+ * split until it stops changing (Moore's algorithm). May throw a ParseError,
+ * which at compile time fails the build.
+ */
+constexpr Automaton Compile(std::string_view pattern) {
+  Lexer lex(pattern);
+  Parser parser(lex.Lex());
+  const NFABuilder::Fragment fragment = parser.ParseFragment();
+  const NFABuilder &nfa = parser.Nfa();
+
+  Automaton res;
+
+  // Transitions grouped by source state
+  const uint64_t n = nfa.NumStates();
+  std::vector<uint64_t> offsets(n + 1, 0);
+  for (const NFABuilder::Edge &edge : nfa.Edges())
+    ++offsets[edge.from + 1];
+  for (uint64_t state = 0; state < n; ++state)
+    offsets[state + 1] += offsets[state];
+
+  std::vector<FSA::Transition> arcs(nfa.Edges().size(), FSA::Transition{0, 0});
+  std::vector<uint64_t> fill(offsets.begin(), offsets.end() - 1);
+  for (const NFABuilder::Edge &edge : nfa.Edges())
+    arcs[fill[edge.from]++] = edge.trans;
+
+  // Bytes between two consecutive range bounds behave the same everywhere
+  std::array<bool, 257> cuts{};
+  for (const FSA::Transition &trans : arcs) {
+    if (!FSA::IsEpsilon(trans.label)) {
+      cuts[trans.label] = true;
+      cuts[trans.hi + 1] = true;
+    }
+  }
+
+  std::vector<uint8_t> representatives;
+  for (uint64_t byte = 0; byte < 256; ++byte) {
+    if (byte == 0 || cuts[byte])
+      representatives.push_back(byte);
+    res.classes[byte] = representatives.size() - 1;
+  }
+  const uint64_t n_classes = representatives.size();
+
+  // Sorted epsilon closure of the states in seeds
+  auto close = [&](const std::vector<uint64_t> &seeds) {
+    std::vector<bool> seen(n, false);
+    std::vector<uint64_t> set;
+    for (uint64_t state : seeds) {
+      if (!seen[state]) {
+        seen[state] = true;
+        set.push_back(state);
+      }
+    }
+
+    for (uint64_t i = 0; i < set.size(); ++i) {
+      for (uint64_t a = offsets[set[i]]; a < offsets[set[i] + 1]; ++a) {
+        if (FSA::IsEpsilon(arcs[a].label) && !seen[arcs[a].to]) {
+          seen[arcs[a].to] = true;
+          set.push_back(arcs[a].to);
+        }
+      }
+    }
+
+    std::sort(set.begin(), set.end());
+    return set;
+  };
+
+  // The empty subset is the dead state
+  std::vector<std::vector<uint64_t>> subsets{{}};
+  if (!fragment.Empty())
+    subsets.push_back(close({fragment.start}));
+
+  std::vector<uint64_t> next;
+  for (uint64_t i = 0; i < subsets.size(); ++i) {
+    for (uint64_t cls = 0; cls < n_classes; ++cls) {
+      std::vector<uint64_t> moves;
+      for (uint64_t state : subsets[i]) {
+        for (uint64_t a = offsets[state]; a < offsets[state + 1]; ++a) {
+          if (!FSA::IsEpsilon(arcs[a].label) &&
+              arcs[a].Covers(representatives[cls]))
+            moves.push_back(arcs[a].to);
+        }
+      }
+
+      const std::vector<uint64_t> target = close(moves);
+      const auto it = std::find(subsets.begin(), subsets.end(), target);
+      next.push_back(it - subsets.begin());
+      if (it == subsets.end())
+        subsets.push_back(target);
+    }
+  }
+
+  const uint64_t n_subsets = subsets.size();
+  std::vector<bool> accepting(n_subsets, false);
+  for (uint64_t i = 1; i < n_subsets; ++i)
+    accepting[i] = std::binary_search(subsets[i].begin(), subsets[i].end(),
+                                      fragment.accept);
+
+  // Blocks are numbered in order of their first state, so the dead state's
+  // block stays 0
+  std::vector<uint64_t> block(n_subsets);
+  for (uint64_t i = 0; i < n_subsets; ++i)
+    block[i] = accepting[i];
+
+  uint64_t n_blocks{0};
+  while (true) {
+    std::vector<std::vector<uint64_t>> signatures;
+    std::vector<uint64_t> refined(n_subsets);
+
+    for (uint64_t i = 0; i < n_subsets; ++i) {
+      std::vector<uint64_t> signature{block[i]};
+      for (uint64_t cls = 0; cls < n_classes; ++cls)
+        signature.push_back(block[next[i * n_classes + cls]]);
+
+      const auto it =
+          std::find(signatures.begin(), signatures.end(), signature);
+      refined[i] = it - signatures.begin();
+      if (it == signatures.end())
+        signatures.push_back(signature);
+    }
+
+    if (signatures.size() == n_blocks)
+      break;
+    n_blocks = signatures.size();
+    block = refined;
+  }
+
+  res.n_classes = n_classes;
+  res.n_states = n_blocks;
+  res.next.assign(n_blocks * n_classes, 0);
+  res.accepting.assign(n_blocks, false);
+  for (uint64_t i = 0; i < n_subsets; ++i) {
+    for (uint64_t cls = 0; cls < n_classes; ++cls)
+      res.next[block[i] * n_classes + cls] = block[next[i * n_classes + cls]];
+    res.accepting[block[i]] = accepting[i];
+  }
+  res.start = n_subsets > 1 ? block[1] : 0;
+
+  return res;
+}
+
+constexpr Shape ShapeOf(std::string_view pattern) {
+  const Automaton automaton = Compile(pattern);
+  return {automaton.n_states, automaton.n_classes};
+}
+
+// Compiles pattern again, now that its shape is known, into its table
+template <uint64_t States, uint64_t Classes>
+constexpr Table<States, Classes> Freeze(std::string_view pattern) {
+  using State = typename Table<States, Classes>::State;
+  const Automaton automaton = Compile(pattern);
+
+  Table<States, Classes> res;
+  res.classes = automaton.classes;
+  for (uint64_t i = 0; i < States * Classes; ++i)
+    res.next[i] = static_cast<State>(automaton.next[i]);
+  for (uint64_t i = 0; i < States; ++i)
+    res.accepting[i] = automaton.accepting[i];
+  res.start = static_cast<State>(automaton.start);
+  return res;
+}
+
+} // namespace Static
+
+/*
+ * Matcher for a pattern known at compile time, e.g.
+ * StaticMatcher<"(a|b)*abb">. Each pattern is its own type, holding nothing
+ * but its table, and every member is static
+ */
+template <FixedString Pattern> class StaticMatcher {
+private:
+  static constexpr Static::Shape shape = Static::ShapeOf(Pattern.View());
+
+  using Table = Static::Table<shape.states, shape.classes>;
+  using State = typename Table::State;
+
+  static constexpr Table table =
+      Static::Freeze<shape.states, shape.classes>(Pattern.View());
+
+public:
+  static constexpr std::string_view Expression() { return Pattern.View(); }
+
+  // Counting the dead state, like DFA::NumStates
+  static constexpr uint64_t NumStates() { return shape.states; }
+
+  static constexpr uint64_t NumClasses() { return shape.classes; }
+
+  // Bytes taken up by the table
+  static constexpr uint64_t MemoryUsage() { return sizeof(Table); }
+
+  /*
+   * Check if the input string is in the language. Usable in constant
+   * expressions
+   */
+  static constexpr bool Match(std::string_view input) {
+    State state = table.start;
+
+    for (char c : input) {
+      state = table.next[state * shape.classes +
+                         table.classes[static_cast<uint8_t>(c)]];
+
+      if (state == 0)
+        return false;
+    }
+
+    return table.accepting[state];
+  }
+
+  static bool Match(std::span<const uint8_t> input) {
+    return Match(std::string_view(reinterpret_cast<const char *>(input.data()),
+                                  input.size()));
+  }
+};
+
+} // namespace Regex
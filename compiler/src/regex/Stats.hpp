@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/*
+ * Counters for seeing where compiling and matching a regex spend their time
+ * and memory. Compile stats are a handful of clock reads and sizes per
+ * compile, so they're always kept. Match stats are opt-in per Matcher, since
+ * they cost a branch and a few adds per match; the per-byte loops are never
+ * touched, engines only report how far they got once a match is over.
+ *
+ * Building with REGEX_STATS=0 compiles every counter out, and the structs
+ * below just stay zeroed.
+ */
+
+#ifndef REGEX_STATS
+#define REGEX_STATS 1
+#endif
+
+constexpr bool StatsEnabled{REGEX_STATS};
+
+struct CompileStats {
+  // After parsing
+  uint64_t nfa_states{0};
+  uint64_t nfa_transitions{0};
+  // After subset construction, and again after minimization
+  uint64_t dfa_states{0};
+  uint64_t dfa_transitions{0};
+  uint64_t min_states{0};
+  uint64_t min_transitions{0};
+
+  // Epsilon closures unioned into subsets while determinizing, one per move
+  // out of each subset
+  uint64_t epsilon_closures{0};
+
+  // Nanoseconds spent lexing and parsing, computing every state's epsilon
+  // closure, building subsets, minimizing and freezing the table
+  uint64_t parse_ns{0};
+  uint64_t closures_ns{0};
+  uint64_t subsets_ns{0};
+  uint64_t minimize_ns{0};
+  uint64_t table_ns{0};
+
+  // Bytes held by the parsed NFA's transitions, and by the final table
+  uint64_t nfa_bytes{0};
+  uint64_t table_bytes{0};
+
+  // Most bytes held at once by the working structures of subset construction
+  // and of minimization, on top of the FSA itself. Counts what the containers
+  // have reserved (and an estimate of the hash map's nodes), not allocator
+  // overhead
+  uint64_t determinize_peak_bytes{0};
+  uint64_t minimize_peak_bytes{0};
+};
+
+struct MatchStats {
+  uint64_t matches{0};
+  // Bytes consumed, which is less than the input for matches that died early.
+  // A FindAll takes one step per byte for every run it is following
+  uint64_t steps{0};
+  // Matches that ended because no match was possible any more
+  uint64_t dead_exits{0};
+};
+
+// How far one match got, filled in by an engine when it returns
+struct MatchTrace {
+  uint64_t steps{0};
+  bool dead{false};
+};
+
+// Adds the time from construction to destruction to a counter, or does
+// nothing at all with stats compiled out or a null counter
+class StatsTimer {
+private:
+  uint64_t *counter;
+  std::chrono::steady_clock::time_point start{};
+
+public:
+  explicit StatsTimer(uint64_t *counter) : counter(counter) {
+    if constexpr (StatsEnabled) {
+      if (counter)
+        start = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~StatsTimer() {
+    if constexpr (StatsEnabled) {
+      if (counter)
+        *counter += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    }
+  }
+
+  StatsTimer(const StatsTimer &) = delete;
+  StatsTimer &operator=(const StatsTimer &) = delete;
+};
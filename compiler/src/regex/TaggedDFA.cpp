@@ -0,0 +1,319 @@
+#include "TaggedDFA.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Tag values while building a state: a register of the state being left, or
+// one of these
+constexpr uint64_t NewValue{UINT64_MAX - 1};
+constexpr uint64_t UnsetValue{UINT64_MAX};
+
+// An NFA state reached by some path, with the value of every tag on it
+struct Config {
+  uint64_t state;
+  std::vector<uint64_t> values;
+};
+
+class Builder {
+private:
+  const FSA &nfa;
+  const uint64_t n_tags;
+
+  // Register of the kth distinct value of each tag within a state
+  std::vector<std::vector<uint32_t>> canonical;
+  uint32_t n_registers{0};
+
+  std::vector<uint64_t> visited;
+  uint64_t stamp{0};
+
+public:
+  // Registers used to break copy cycles, not part of any state
+  uint32_t temp;
+
+  Builder(const FSA &nfa, uint64_t n_tags)
+      : nfa(nfa), n_tags(n_tags), canonical(n_tags),
+        visited(nfa.NumStates(), UINT64_MAX) {
+    temp = n_registers++;
+  }
+
+  uint32_t NumRegisters() const { return n_registers; }
+
+  uint32_t Register(uint64_t tag, uint64_t k) {
+    while (canonical[tag].size() <= k)
+      canonical[tag].push_back(n_registers++);
+    return canonical[tag][k];
+  }
+
+  bool Important(uint64_t state) const {
+    if (nfa.IsAcceptState(state))
+      return true;
+    for (const FSA::Transition &trans : nfa.TransitionsFrom(state)) {
+      if (!FSA::IsEpsilon(trans.label))
+        return true;
+    }
+    return false;
+  }
+
+  /*
+   * Everything reachable from the seeds without consuming input, in order of
+   * preference: seeds in order, and depth first through each state's
+   * transitions in order. The first path to reach a state wins. Only states
+   * that consume input or accept are kept
+   */
+  std::vector<Config> Closure(std::vector<Config> seeds) {
+    ++stamp;
+    std::vector<Config> res;
+    std::vector<Config> stack;
+
+    for (Config &seed : seeds) {
+      stack.push_back(std::move(seed));
+
+      while (!stack.empty()) {
+        Config config = std::move(stack.back());
+        stack.pop_back();
+
+        if (visited[config.state] == stamp)
+          continue;
+        visited[config.state] = stamp;
+
+        std::span<const FSA::Transition> out =
+            nfa.TransitionsFrom(config.state);
+        for (auto trans = out.rbegin(); trans != out.rend(); ++trans) {
+          if (!FSA::IsEpsilon(trans->label) || visited[trans->to] == stamp)
+            continue;
+
+          Config next{trans->to, config.values};
+          if (FSA::IsTag(trans->label))
+            next.values[FSA::TagOf(trans->label)] = NewValue;
+          stack.push_back(std::move(next));
+        }
+
+        if (Important(config.state))
+          res.push_back(std::move(config));
+      }
+    }
+
+    return res;
+  }
+
+  /*
+   * Number the values of every tag canonically, giving the key of the state
+   * the configs form, and the operations that move the values into place.
+   * Copies read the registers of the state being left, so they are ordered
+   * such that nothing is overwritten before it's read
+   */
+  std::vector<uint64_t> Canonicalize(std::vector<Config> &configs,
+                                     std::vector<TaggedDFA::RegisterOp> &ops) {
+    using Kind = TaggedDFA::RegisterOp::Kind;
+
+    std::vector<TaggedDFA::RegisterOp> copies;
+    std::vector<TaggedDFA::RegisterOp> sets;
+    std::vector<uint64_t> seen;
+
+    for (uint64_t tag = 0; tag < n_tags; ++tag) {
+      seen.clear();
+      for (Config &config : configs) {
+        const uint64_t value = config.values[tag];
+        uint64_t k = std::find(seen.begin(), seen.end(), value) - seen.begin();
+        const uint32_t reg = Register(tag, k);
+
+        if (k == seen.size()) {
+          seen.push_back(value);
+          if (value == NewValue)
+            sets.push_back({Kind::Set, reg, 0});
+          else if (value == UnsetValue)
+            sets.push_back({Kind::Clear, reg, 0});
+          else if (value != reg)
+            copies.push_back({Kind::Copy, reg, static_cast<uint32_t>(value)});
+        }
+
+        config.values[tag] = reg;
+      }
+    }
+
+    // Parallel copy: emit a copy once nothing pending still reads its
+    // destination, and break cycles through temp
+    while (!copies.empty()) {
+      auto ready = std::find_if(
+          copies.begin(), copies.end(), [&](const TaggedDFA::RegisterOp &op) {
+            return std::none_of(copies.begin(), copies.end(),
+                                [&](const TaggedDFA::RegisterOp &other) {
+                                  return other.src == op.dst;
+                                });
+          });
+
+      if (ready == copies.end()) {
+        const uint32_t saved = copies.front().dst;
+        ops.push_back({Kind::Copy, temp, saved});
+        for (TaggedDFA::RegisterOp &op : copies) {
+          if (op.src == saved)
+            op.src = temp;
+        }
+        continue;
+      }
+
+      if (ready->dst != ready->src)
+        ops.push_back(*ready);
+      copies.erase(ready);
+    }
+
+    ops.insert(ops.end(), sets.begin(), sets.end());
+
+    std::vector<uint64_t> key;
+    key.reserve(configs.size() * (n_tags + 1));
+    for (const Config &config : configs) {
+      key.push_back(config.state);
+      key.insert(key.end(), config.values.begin(), config.values.end());
+    }
+    return key;
+  }
+};
+
+} // namespace
+
+TaggedDFA::TaggedDFA(const FSA &nfa, uint64_t n_tags)
+    : n_tags(n_tags), classes(nfa) {
+  const uint64_t stride = classes.NumClasses();
+  const auto representatives = classes.Representatives();
+
+  Builder builder(nfa, n_tags);
+
+  std::unordered_map<std::vector<uint64_t>, uint32_t, FSA::StateSetHash> ids;
+  // Configs of every state, with values holding registers
+  std::vector<std::vector<Config>> states;
+
+  auto add_state = [&](std::vector<Config> configs,
+                       const std::vector<uint64_t> &key) {
+    auto [it, inserted] = ids.try_emplace(key, states.size());
+    if (inserted) {
+      states.push_back(std::move(configs));
+      table.resize(table.size() + stride, Dead);
+    }
+    return it->second;
+  };
+
+  // The dead state has no configs at all
+  add_state({}, {});
+
+  if (nfa.NumStates() > 0) {
+    std::vector<Config> start = builder.Closure(
+        {Config{nfa.StartState(), std::vector<uint64_t>(n_tags, UnsetValue)}});
+    std::vector<uint64_t> key = builder.Canonicalize(start, start_ops);
+    start_state = add_state(std::move(start), key);
+  }
+
+  // Operations per table entry, flattened once every state is known
+  std::vector<std::vector<RegisterOp>> entry_ops(table.size());
+
+  for (uint64_t state = 1; state < states.size(); ++state) {
+    for (uint64_t cls = 0; cls < stride; ++cls) {
+      const int64_t byte = representatives[cls];
+
+      std::vector<Config> seeds;
+      for (const Config &config : states[state]) {
+        for (const FSA::Transition &trans :
+             nfa.TransitionsFrom(config.state)) {
+          if (trans.Covers(byte))
+            seeds.push_back({trans.to, config.values});
+        }
+      }
+
+      std::vector<Config> next = builder.Closure(std::move(seeds));
+      if (next.empty())
+        continue;
+
+      std::vector<RegisterOp> moves;
+      std::vector<uint64_t> key = builder.Canonicalize(next, moves);
+      const uint32_t id = add_state(std::move(next), key);
+
+      table[state * stride + cls] = id;
+      entry_ops.resize(table.size());
+      entry_ops[state * stride + cls] = std::move(moves);
+    }
+  }
+
+  op_offsets.reserve(table.size() + 1);
+  op_offsets.push_back(0);
+  for (uint64_t entry = 0; entry < table.size(); ++entry) {
+    ops.insert(ops.end(), entry_ops[entry].begin(), entry_ops[entry].end());
+    op_offsets.push_back(ops.size());
+  }
+
+  accept_states.resize(states.size(), false);
+  finals.resize(states.size() * n_tags, 0);
+  for (uint64_t state = 0; state < states.size(); ++state) {
+    auto accepting = std::find_if(
+        states[state].begin(), states[state].end(),
+        [&](const Config &config) { return nfa.IsAcceptState(config.state); });
+    if (accepting == states[state].end())
+      continue;
+
+    accept_states[state] = true;
+    for (uint64_t tag = 0; tag < n_tags; ++tag)
+      finals[state * n_tags + tag] = accepting->values[tag];
+  }
+
+  registers.resize(builder.NumRegisters(), NoPosition);
+}
+
+void TaggedDFA::Apply(std::span<const RegisterOp> to_apply, size_t position) {
+  for (const RegisterOp &op : to_apply) {
+    switch (op.kind) {
+    case RegisterOp::Kind::Set:
+      registers[op.dst] = position;
+      break;
+    case RegisterOp::Kind::Copy:
+      registers[op.dst] = registers[op.src];
+      break;
+    case RegisterOp::Kind::Clear:
+      registers[op.dst] = NoPosition;
+      break;
+    }
+  }
+}
+
+bool TaggedDFA::Match(std::span<const uint8_t> input, std::span<size_t> tags) {
+  assert(tags.size() >= n_tags);
+
+  if (start_state == Dead)
+    return false;
+
+  const uint64_t stride = classes.NumClasses();
+  uint32_t state = start_state;
+  Apply(start_ops, 0);
+
+  for (size_t i = 0; i < input.size(); ++i) {
+    const uint64_t entry = state * stride + classes[input[i]];
+    state = table[entry];
+
+    if (state == Dead)
+      return false;
+
+    Apply({ops.data() + op_offsets[entry], ops.data() + op_offsets[entry + 1]},
+          i + 1);
+  }
+
+  if (!accept_states[state])
+    return false;
+
+  for (uint64_t tag = 0; tag < n_tags; ++tag)
+    tags[tag] = registers[finals[state * n_tags + tag]];
+
+  return true;
+}
+
+bool TaggedDFA::Match(std::string_view input, std::span<size_t> tags) {
+  return Match(std::span<const uint8_t>(
+                   reinterpret_cast<const uint8_t *>(input.data()),
+                   input.size()),
+               tags);
+}
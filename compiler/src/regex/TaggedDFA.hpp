@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "ByteClasses.hpp"
+#include "FSA.hpp"
+
+/*
+ * DFA that also reports where in the input the tags of an NFA (FSA::Tag) were
+ * passed, following Laurikari's tagged DFAs. Each DFA state stands for an
+ * ordered list of NFA states, each with the register holding the last
+ * position of every tag along its best path so far. Transitions carry register
+ * operations (set to the current position, or copy another register) that
+ * keep the registers up to date, so matching is still one table lookup per
+ * byte plus a few register moves, with no backtracking.
+ *
+ * Ambiguity is resolved like a backtracking matcher would: earlier
+ * transitions out of an NFA state are preferred over later ones, which makes
+ * alternation prefer its left side and stars greedy. Of two paths reaching the
+ * same NFA state at the same point only the preferred one is kept, as in a
+ * Pike VM.
+ *
+ * Registers are numbered canonically in each DFA state (per tag, in order of
+ * first use), so two subsets whose paths only differ in where their tag values
+ * came from map to the same DFA state, and the copies needed to get there are
+ * put on the transition.
+ */
+class TaggedDFA {
+public:
+  static constexpr uint32_t Dead{0};
+  // Value of a tag that was never passed
+  static constexpr size_t NoPosition{SIZE_MAX};
+
+  struct RegisterOp {
+    enum class Kind : uint8_t { Set, Copy, Clear };
+
+    Kind kind;
+    uint32_t dst;
+    uint32_t src;
+  };
+
+private:
+  uint64_t n_tags{0};
+  ByteClasses classes{};
+  uint32_t start_state{Dead};
+
+  // [state][class], like DFA
+  std::vector<uint32_t> table{};
+  // Operations of table entry i are ops[op_offsets[i]..op_offsets[i + 1]]
+  std::vector<uint32_t> op_offsets{};
+  std::vector<RegisterOp> ops{};
+  // Run before the first byte
+  std::vector<RegisterOp> start_ops{};
+
+  std::vector<bool> accept_states{};
+  // Register holding each tag when accepting in a state, n_tags per state
+  std::vector<uint32_t> finals{};
+
+  // Reused between matches
+  std::vector<size_t> registers{};
+
+  void Apply(std::span<const RegisterOp> to_apply, size_t position);
+
+public:
+  // The FSA's tags must be in [0, n_tags)
+  TaggedDFA(const FSA &nfa, uint64_t n_tags);
+
+  uint64_t NumStates() const { return accept_states.size(); }
+
+  uint64_t NumRegisters() const { return registers.size(); }
+
+  uint64_t NumTags() const { return n_tags; }
+
+  /*
+   * Check if the whole input is in the language and, if so, store the last
+   * position each tag was passed at in tags, or NoPosition. tags must hold at
+   * least NumTags() values. Doesn't allocate
+   */
+  bool Match(std::span<const uint8_t> input, std::span<size_t> tags);
+
+  bool Match(std::string_view input, std::span<size_t> tags);
+};
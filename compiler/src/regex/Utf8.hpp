@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/*
+ * UTF-8 as the automata see it. Matching runs over bytes, so a range of code
+ * points becomes a handful of sequences of byte ranges, e.g. U+0400..U+04FF is
+ * [D0-D3][80-BF], rather than one arc per code point. Everything here is
+ * constexpr so the regex front end can run at compile time, see StaticRegex.
+ */
+namespace Utf8 {
+
+constexpr char32_t MaxCodePoint{0x10FFFF};
+constexpr char32_t SurrogateBegin{0xD800};
+constexpr char32_t SurrogateEnd{0xDFFF};
+
+struct ByteRange {
+  uint8_t lo;
+  uint8_t hi;
+
+  auto operator<=>(const ByteRange &) const = default;
+};
+
+// One to four byte ranges, matching the encodings of a range of code points
+// byte by byte
+struct Sequence {
+  std::array<ByteRange, 4> ranges{};
+  uint8_t length{0};
+};
+
+namespace Detail {
+
+// Largest code point of each encoded length
+constexpr char32_t MaxOfLength[]{0x7F, 0x7FF, 0xFFFF, MaxCodePoint};
+
+} // namespace Detail
+
+// Number of bytes cp encodes to
+constexpr size_t EncodedLength(char32_t cp) {
+  if (cp <= Detail::MaxOfLength[0])
+    return 1;
+  if (cp <= Detail::MaxOfLength[1])
+    return 2;
+  if (cp <= Detail::MaxOfLength[2])
+    return 3;
+  return 4;
+}
+
+namespace Detail {
+
+constexpr void Encode(char32_t cp, uint8_t *out) {
+  switch (EncodedLength(cp)) {
+  case 1:
+    out[0] = cp;
+    break;
+  case 2:
+    out[0] = 0xC0 | (cp >> 6);
+    out[1] = 0x80 | (cp & 0x3F);
+    break;
+  case 3:
+    out[0] = 0xE0 | (cp >> 12);
+    out[1] = 0x80 | ((cp >> 6) & 0x3F);
+    out[2] = 0x80 | (cp & 0x3F);
+    break;
+  default:
+    out[0] = 0xF0 | (cp >> 18);
+    out[1] = 0x80 | ((cp >> 12) & 0x3F);
+    out[2] = 0x80 | ((cp >> 6) & 0x3F);
+    out[3] = 0x80 | (cp & 0x3F);
+    break;
+  }
+}
+
+/*
+ * [lo, hi] all encode to the same length. While lo and hi differ in some
+ * continuation byte that isn't the full 80..BF, the range is cut there, and
+ * once every later byte spans its whole range, the encodings of lo and hi
+ * give the byte ranges directly.
+ */
+constexpr void Split(char32_t lo, char32_t hi, std::vector<Sequence> &out) {
+  const size_t length = EncodedLength(lo);
+  assert(EncodedLength(hi) == length);
+
+  for (size_t i = 1; i < length; ++i) {
+    const char32_t mask = (char32_t{1} << (6 * i)) - 1;
+    if ((lo & ~mask) == (hi & ~mask))
+      continue;
+
+    if ((lo & mask) != 0) {
+      Split(lo, lo | mask, out);
+      Split((lo | mask) + 1, hi, out);
+      return;
+    }
+    if ((hi & mask) != mask) {
+      Split(lo, (hi & ~mask) - 1, out);
+      Split(hi & ~mask, hi, out);
+      return;
+    }
+  }
+
+  uint8_t lo_bytes[4]{};
+  uint8_t hi_bytes[4]{};
+  Encode(lo, lo_bytes);
+  Encode(hi, hi_bytes);
+
+  Sequence seq;
+  seq.length = length;
+  for (size_t i = 0; i < length; ++i)
+    seq.ranges[i] = {lo_bytes[i], hi_bytes[i]};
+  out.push_back(seq);
+}
+
+} // namespace Detail
+
+/*
+ * Decodes the code point at the front of str into cp, returning the number of
+ * bytes it takes, or 0 if str doesn't start with a well formed encoding.
+ * Overlong encodings and surrogates aren't well formed.
+ */
+constexpr size_t Decode(std::string_view str, char32_t &cp) {
+  if (str.empty())
+    return 0;
+
+  const uint8_t lead = str[0];
+  size_t length;
+  if (lead < 0x80) {
+    cp = lead;
+    return 1;
+  } else if ((lead & 0xE0) == 0xC0) {
+    length = 2;
+    cp = lead & 0x1F;
+  } else if ((lead & 0xF0) == 0xE0) {
+    length = 3;
+    cp = lead & 0x0F;
+  } else if ((lead & 0xF8) == 0xF0) {
+    length = 4;
+    cp = lead & 0x07;
+  } else {
+    return 0;
+  }
+
+  if (str.size() < length)
+    return 0;
+
+  for (size_t i = 1; i < length; ++i) {
+    const uint8_t byte = str[i];
+    if ((byte & 0xC0) != 0x80)
+      return 0;
+    cp = (cp << 6) | (byte & 0x3F);
+  }
+
+  if (cp > MaxCodePoint || EncodedLength(cp) != length ||
+      (cp >= SurrogateBegin && cp <= SurrogateEnd))
+    return 0;
+
+  return length;
+}
+
+/*
+ * Splits [lo, hi] into sequences whose byte ranges match exactly the
+ * encodings of the code points in it. Surrogates are left out, since they have
+ * no encoding.
+ */
+constexpr std::vector<Sequence> Sequences(char32_t lo, char32_t hi) {
+  std::vector<Sequence> res;
+  if (hi > MaxCodePoint)
+    hi = MaxCodePoint;
+
+  while (lo <= hi) {
+    // Skip the surrogates, then take as much as encodes to one length
+    if (lo >= SurrogateBegin && lo <= SurrogateEnd) {
+      lo = SurrogateEnd + 1;
+      continue;
+    }
+
+    char32_t end = Detail::MaxOfLength[EncodedLength(lo) - 1];
+    if (lo < SurrogateBegin)
+      end = std::min(end, static_cast<char32_t>(SurrogateBegin - 1));
+    end = std::min(end, hi);
+
+    Detail::Split(lo, end, res);
+    lo = end + 1;
+  }
+
+  return res;
+}
+
+} // namespace Utf8
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <climits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <variant>
+
+#include "interpreter/Bytecode.hpp"
+#include "interpreter/Eval.hpp"
+#include "interpreter/Lexer.hpp"
+#include "interpreter/Parser.hpp"
+
+namespace {
+
+Chunk Compile(std::string_view input) {
+  Lexer lexer(input);
+  Ast ast;
+  Parser parser(lexer.Lex(), ast);
+  BytecodeCompiler compiler;
+  return compiler.Compile(ast, parser.Parse());
+}
+
+int Evaluate(std::string_view input) {
+  VM vm;
+  return vm.Run(Compile(input));
+}
+
+// Random expression with every operator, parentheses and unary minus
+std::string RandomExpression(std::mt19937 &gen, int depth) {
+  std::uniform_int_distribution<int> shape(0, depth > 0 ? 5 : 0);
+  std::uniform_int_distribution<int> value(0, 99);
+  static constexpr std::string_view ops = "+-*/";
+
+  std::string res;
+  switch (shape(gen)) {
+  case 0:
+    res += std::to_string(value(gen));
+    break;
+  case 1:
+    res += '-';
+    res += RandomExpression(gen, depth - 1);
+    break;
+  case 2:
+    res += '(';
+    res += RandomExpression(gen, depth - 1);
+    res += ')';
+    break;
+  default:
+    res += RandomExpression(gen, depth - 1);
+    res += ' ';
+    res += ops[gen() % 4];
+    res += ' ';
+    res += RandomExpression(gen, depth - 1);
+    break;
+  }
+  return res;
+}
+
+} // namespace
+
+TEST(BytecodeTests, Precedence) {
+  ASSERT_EQ(Evaluate("(2 * 3) + 4"), 10);
+  ASSERT_EQ(Evaluate("2 + 3 * 4"), 14);
+  ASSERT_EQ(Evaluate("10 - 4 - 3"), 3);
+  ASSERT_EQ(Evaluate("100 / 10 / 5"), 2);
+  ASSERT_EQ(Evaluate("--3 * -(2 - 7)"), 15);
+  ASSERT_EQ(Evaluate("7 / -2"), -3);
+}
+
+TEST(BytecodeTests, Code) {
+  const Chunk chunk = Compile("1 + 2 * -3");
+
+  ASSERT_EQ(chunk.code.size(), 7);
+  ASSERT_EQ(chunk.code[0].op, OpCode::Push);
+  ASSERT_EQ(chunk.code[3].op, OpCode::Negate);
+  ASSERT_EQ(chunk.code[4].op, OpCode::Multiply);
+  ASSERT_EQ(chunk.code[5].op, OpCode::Add);
+  ASSERT_EQ(chunk.code[6].op, OpCode::Return);
+  ASSERT_EQ(chunk.max_stack, 3);
+
+  // Literal right operands are fused into the operator
+  const Chunk fused = Compile("(1 - 2) * 3");
+  ASSERT_EQ(fused.code.size(), 4);
+  ASSERT_EQ(fused.code[1].op, OpCode::SubtractConst);
+  ASSERT_EQ(fused.code[2].op, OpCode::MultiplyConst);
+  ASSERT_EQ(fused.code[2].operand, 3);
+  ASSERT_EQ(fused.max_stack, 1);
+}
+
+TEST(BytecodeTests, Errors) {
+  ASSERT_THROW(Compile("1 +"), CompileError);
+  ASSERT_THROW(Compile(""), CompileError);
+  ASSERT_THROW(Evaluate("1 / (2 - 2)"), EvalError);
+}
+
+TEST(BytecodeTests, Wraps) {
+  ASSERT_EQ(Evaluate("2147483647 + 1"), INT_MIN);
+  ASSERT_EQ(Evaluate("(-2147483647 - 1) / -1"), INT_MIN);
+}
+
+TEST(BytecodeTests, AgreesWithTreeWalk) {
+  std::mt19937 gen(30);
+  Ast ast;
+  BytecodeCompiler compiler;
+  VM vm;
+
+  for (int i = 0; i < 500; ++i) {
+    const std::string input = RandomExpression(gen, 6);
+    ast.Clear();
+    Lexer lexer(input);
+    Parser parser(lexer.Lex(), ast);
+    const ExprHandle root = parser.Parse();
+    const Chunk chunk = compiler.Compile(ast, root);
+
+    int expected{0};
+    try {
+      expected = std::visit(AstEvaluator{ast}, ast[root]);
+    } catch (const EvalError &) {
+      ASSERT_THROW(vm.Run(chunk), EvalError) << input;
+      continue;
+    }
+    ASSERT_EQ(vm.Run(chunk), expected) << input;
+  }
+}
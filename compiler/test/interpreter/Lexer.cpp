@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <string_view>
+#include <vector>
+
+#include "interpreter/Lexer.hpp"
+
+TEST(LexerTests, Tokens) {
+  constexpr std::string_view input = "(12 + 3)*-405";
+  Lexer lexer(input);
+  const std::vector<Token> toks = lexer.Lex();
+
+  ASSERT_EQ(toks.size(), 8);
+  ASSERT_EQ(toks[0].type, LeftParen);
+  ASSERT_EQ(toks[1].type, Integer);
+  ASSERT_EQ(toks[1].value, 12);
+  ASSERT_EQ(toks[1].Lexeme(input), "12");
+  ASSERT_EQ(toks[2].type, Plus);
+  ASSERT_EQ(toks[2].offset, 4);
+  ASSERT_EQ(toks[5].type, Star);
+  ASSERT_EQ(toks[6].type, Minus);
+  ASSERT_EQ(toks[7].value, 405);
+  ASSERT_EQ(toks[7].Lexeme(input), "405");
+}
+
+// Reserved up front for one token per two characters, and grown past that
+TEST(LexerTests, Reserved) {
+  constexpr std::string_view spaced = "1 + 2 + 3 + 4 + 5 + 6 + 7 + 8 + 9";
+  const std::vector<Token> toks = Lexer(spaced).Lex();
+  ASSERT_EQ(toks.size(), 17);
+  ASSERT_EQ(toks.capacity(), 17);
+
+  constexpr std::string_view dense = "1+2+3+4+5+6+7+8+9";
+  ASSERT_EQ(Lexer(dense).Lex().size(), dense.size());
+}
+
+TEST(LexerTests, Errors) {
+  ASSERT_THROW(Lexer("1 + x").Lex(), LexError);
+  ASSERT_EQ(Lexer("2147483647").Lex()[0].value, 2147483647);
+  ASSERT_THROW(Lexer("2147483648").Lex(), LexError);
+}
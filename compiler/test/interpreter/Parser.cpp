@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <variant>
+
+#include "interpreter/Lexer.hpp"
+#include "interpreter/Parser.hpp"
+
+namespace {
+
+std::string Print(std::string_view input) {
+  Lexer lexer(input);
+  Ast ast;
+  Parser parser(lexer.Lex(), ast);
+  const ExprHandle root = parser.Parse();
+  return std::visit(AstPrinter{ast}, ast[root]);
+}
+
+} // namespace
+
+TEST(ParserTests, Tree) {
+  ASSERT_EQ(Print("(2 * 3) + 4"), "BinaryExpr + (BinaryExpr * (IntegerLit 2) "
+                                  "(IntegerLit 3)) (IntegerLit 4)");
+  ASSERT_EQ(Print("-1 - 2"),
+            "BinaryExpr - (UnaryExpr - (IntegerLit 1)) (IntegerLit 2)");
+  ASSERT_THROW(Print("(1 + 2"), ParseError);
+}
+
+// Children come before their parents in the pool, and a missing operand is
+// NoExpr rather than a node
+TEST(ParserTests, Pool) {
+  Lexer lexer("1 + 2 * 3 +");
+  Ast ast;
+  Parser parser(lexer.Lex(), ast);
+  const ExprHandle root = parser.Parse();
+
+  ASSERT_EQ(ast.Size(), 6);
+  ASSERT_EQ(root, 5);
+  const auto &top = std::get<BinaryExpr>(ast[root]);
+  ASSERT_EQ(top.right, NoExpr);
+  ASSERT_LT(top.left, root);
+}
+
+// Clearing frees every node at once, and the next tree reuses the memory
+TEST(ParserTests, Clear) {
+  Ast ast;
+  Lexer first("1 + 2 + 3 + 4");
+  Parser(first.Lex(), ast).Parse();
+  ASSERT_EQ(ast.Size(), 7);
+  const size_t bytes = ast.MemoryUsage();
+
+  ast.Clear();
+  ASSERT_EQ(ast.Size(), 0);
+
+  Lexer second("5 * 6");
+  const ExprHandle root = Parser(second.Lex(), ast).Parse();
+  ASSERT_EQ(root, 2);
+  ASSERT_EQ(ast.MemoryUsage(), bytes);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "regex/Regex.hpp"
+
+/*
+ * Replaces the global allocator for the whole test binary so that the tests
+ * below can count the allocations made between two points. The replacements
+ * are kept out of line: inlined, GCC sees free called on what operator new
+ * returned and warns about a mismatched delete (-Wmismatched-new-delete)
+ */
+
+namespace {
+
+bool counting{false};
+uint64_t allocations{0};
+
+struct CountAllocations {
+  CountAllocations() {
+    allocations = 0;
+    counting = true;
+  }
+  ~CountAllocations() { counting = false; }
+};
+
+} // namespace
+
+[[gnu::noinline]] void *operator new(std::size_t size) {
+  if (counting)
+    ++allocations;
+
+  if (void *ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+[[gnu::noinline]] void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
+const std::vector<std::string> &Inputs() {
+  static const std::vector<std::string> inputs{
+      "",      "abd", "aabc", "bd", "ad", "aaabdsod", std::string(4096, 'a'),
+      "aaaab", "abe", "bc",   "b"};
+  return inputs;
+}
+
+void ExpectNoAllocations(Regex::Engine engine) {
+  Regex::Matcher reg("a*b(c|d)", engine);
+
+  // Let the lazy DFA fill its cache first
+  for (const std::string &input : Inputs())
+    reg.Match(input);
+
+  std::vector<std::span<const uint8_t>> spans;
+  for (const std::string &input : Inputs()) {
+    spans.emplace_back(reinterpret_cast<const uint8_t *>(input.data()),
+                       input.size());
+  }
+
+  uint64_t matched{0};
+  uint64_t counted{0};
+  {
+    CountAllocations count;
+    for (int i = 0; i < 16; ++i) {
+      for (const std::string &input : Inputs())
+        matched += reg.Match(std::string_view(input));
+      for (std::span<const uint8_t> input : spans)
+        matched += reg.Match(input);
+    }
+    counted = allocations;
+  }
+
+  ASSERT_EQ(counted, 0);
+  ASSERT_EQ(matched, 16 * 2 * 4);
+}
+
+} // namespace
+
+TEST(AllocationTests, CountingWorks) {
+  uint64_t counted{0};
+  {
+    CountAllocations count;
+    std::vector<int> vec(16);
+    counted = allocations;
+  }
+  ASSERT_EQ(counted, 1);
+}
+
+TEST(AllocationTests, DfaMatchDoesNotAllocate) {
+  ExpectNoAllocations(Regex::Engine::Dfa);
+}
+
+TEST(AllocationTests, LazyDfaMatchDoesNotAllocate) {
+  ExpectNoAllocations(Regex::Engine::LazyDfa);
+}
+
+TEST(AllocationTests, NfaMatchDoesNotAllocate) {
+  ExpectNoAllocations(Regex::Engine::Nfa);
+}
+
+// However long the input, a stream only carries the state it is in
+TEST(AllocationTests, StreamDoesNotAllocate) {
+  Regex::Matcher reg("a*b(c|d)");
+  const std::string piece(4096, 'a');
+
+  uint64_t counted{0};
+  bool matched{false};
+  {
+    CountAllocations count;
+    MatchState stream = reg.Stream();
+    for (int i = 0; i < 256; ++i)
+      stream.Feed(piece);
+    stream.Feed("bd");
+    matched = stream.Finish();
+    counted = allocations;
+  }
+
+  ASSERT_EQ(counted, 0);
+  ASSERT_TRUE(matched);
+}
+
+TEST(AllocationTests, CapturesDoNotAllocate) {
+  Regex::Matcher reg("(a*)b(c|d)");
+  std::vector<std::optional<MatchSpan>> groups(reg.NumGroups());
+
+  // Builds the tagged DFA
+  for (const std::string &input : Inputs())
+    reg.Match(input, groups);
+
+  uint64_t matched{0};
+  uint64_t counted{0};
+  {
+    CountAllocations count;
+    for (const std::string &input : Inputs())
+      matched += reg.Match(input, groups);
+    counted = allocations;
+  }
+
+  ASSERT_EQ(counted, 0);
+  ASSERT_EQ(matched, 4);
+}
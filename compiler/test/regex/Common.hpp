@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string_view>
+
+#include "regex/FSA.hpp"
+#include "regex/LangFrontend.hpp"
+
+// Helpers shared by the regex tests
+
+// NFA of expression, straight out of the parser
+inline FSA Parse(std::string_view expression) {
+  Regex::Lexer lex(expression);
+  Regex::Parser parser(lex.Lex());
+  return parser.Parse();
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "regex/DFA.hpp"
+#include "regex/FSA.hpp"
+
+// The empty language through every engine is checked in Regex.cpp
+TEST(DFATests, DefaultMatchesNothing) {
+  DFA dfa;
+
+  ASSERT_FALSE(dfa.Match(""));
+  ASSERT_FALSE(dfa.Match("a"));
+}
+
+TEST(DFATests, EvenNumberOfOnes) {
+  FSA fsa;
+  fsa.AddStates(2);
+
+  fsa.AddTransition(0, 0, '0');
+  fsa.AddTransition(0, 1, '1');
+  fsa.AddTransition(1, 1, '0');
+  fsa.AddTransition(1, 0, '1');
+
+  fsa.AcceptState(0);
+
+  DFA dfa{fsa};
+
+  ASSERT_TRUE(dfa.Match(""));
+  ASSERT_FALSE(dfa.Match("1101"));
+  ASSERT_TRUE(dfa.Match("11101"));
+  ASSERT_FALSE(dfa.Match("1102"));
+}
+
+// Anything without a transition falls into the dead state and stays there
+TEST(DFATests, DeadStateAbsorbs) {
+  FSA fsa;
+  fsa.AddStates(3);
+  fsa.AddTransition(0, 1, 'a');
+  fsa.AddTransition(1, 2, 'b');
+  fsa.AcceptState(2);
+
+  DFA dfa{fsa};
+
+  ASSERT_TRUE(dfa.Match("ab"));
+  ASSERT_FALSE(dfa.Match("a"));
+  ASSERT_FALSE(dfa.Match("abb"));
+  ASSERT_FALSE(dfa.Match("bab"));
+
+  uint32_t state = dfa.Next(dfa.StartState(), 'b');
+  ASSERT_EQ(state, DFA::Dead);
+  ASSERT_EQ(dfa.Next(state, 'a'), DFA::Dead);
+}
+
+// Union of two branches sharing a first label must determinize to a single
+// transition on that label
+TEST(DFATests, SharedPrefixDeterminizes) {
+  FSA ab;
+  ab.AddStates(3);
+  ab.AddTransition(0, 1, 'a');
+  ab.AddTransition(1, 2, 'b');
+  ab.AcceptState(2);
+
+  FSA ac;
+  ac.AddStates(3);
+  ac.AddTransition(0, 1, 'a');
+  ac.AddTransition(1, 2, 'c');
+  ac.AcceptState(2);
+
+  FSA fsa = FSA::Union(ab, ac);
+  fsa.Determinize();
+
+  for (uint64_t state = 0; state < fsa.NumStates(); ++state) {
+    std::vector<int64_t> labels;
+    for (const FSA::Transition &trans : fsa.TransitionsFrom(state))
+      labels.push_back(trans.label);
+    std::sort(labels.begin(), labels.end());
+    ASSERT_EQ(std::adjacent_find(labels.begin(), labels.end()), labels.end());
+  }
+
+  DFA dfa{fsa};
+
+  ASSERT_TRUE(dfa.Match("ab"));
+  ASSERT_TRUE(dfa.Match("ac"));
+  ASSERT_FALSE(dfa.Match("a"));
+  ASSERT_FALSE(dfa.Match("abc"));
+}
+
+// Bytes no state tells apart share a class, everything unused ends up in one
+TEST(DFATests, ByteClasses) {
+  FSA fsa;
+  fsa.AddStates(3);
+  fsa.AddTransition(0, 1, 'a');
+  fsa.AddTransition(0, 1, 'b');
+  fsa.AddTransition(1, 2, 'c');
+  fsa.AcceptState(2);
+
+  ByteClasses classes{fsa};
+
+  ASSERT_EQ(classes.NumClasses(), 3);
+  ASSERT_EQ(classes['a'], classes['b']);
+  ASSERT_NE(classes['a'], classes['c']);
+  ASSERT_EQ(classes[0], classes['z']);
+  ASSERT_EQ(classes[0], classes[255]);
+  ASSERT_EQ(classes.Representatives()[classes['b']], 'a');
+
+  DFA dfa{fsa};
+
+  ASSERT_EQ(dfa.NumStates() * dfa.Classes().NumClasses(), 4 * 3);
+  ASSERT_TRUE(dfa.Match("ac"));
+  ASSERT_TRUE(dfa.Match("bc"));
+  ASSERT_FALSE(dfa.Match("cc"));
+  ASSERT_FALSE(dfa.Match("ab"));
+}
+
+// A byte leading to a different state anywhere gets its own class
+TEST(DFATests, ByteClassesSplitOnTarget) {
+  FSA fsa;
+  fsa.AddStates(3);
+  fsa.AddTransition(0, 1, 'a');
+  fsa.AddTransition(0, 1, 'b');
+  fsa.AddTransition(1, 1, 'a');
+  fsa.AddTransition(1, 2, 'b');
+  fsa.AcceptState(2);
+
+  DFA dfa{fsa};
+
+  ASSERT_EQ(dfa.Classes().NumClasses(), 3);
+  ASSERT_TRUE(dfa.Match("aab"));
+  ASSERT_TRUE(dfa.Match("bb"));
+  ASSERT_FALSE(dfa.Match("aba"));
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "regex/DFAFile.hpp"
+#include "regex/PatternSet.hpp"
+#include "regex/Regex.hpp"
+
+namespace {
+
+// Serialized bytes in a buffer aligned like a mapping would be. Files are
+// always a whole number of words long
+std::vector<uint64_t> Serialized(const Regex::Matcher &reg) {
+  std::ostringstream out;
+  reg.Save(out);
+  const std::string bytes = out.str();
+
+  EXPECT_EQ(bytes.size() % 8, 0);
+  std::vector<uint64_t> res(bytes.size() / 8);
+  std::memcpy(res.data(), bytes.data(), bytes.size());
+  return res;
+}
+
+std::span<const std::byte> AsBytes(const std::vector<uint64_t> &words) {
+  return std::as_bytes(std::span(words));
+}
+
+std::string TempPath(std::string_view name) {
+  return ::testing::TempDir() + std::string(name);
+}
+
+} // namespace
+
+TEST(DFAFileTests, ViewAgreesWithMatcher) {
+  std::mt19937 gen(12);
+  std::uniform_int_distribution<int> letter('a', 'c');
+
+  for (std::string_view expression : {"a*b(c|a)", "(ab|c)*", "abc", ""}) {
+    Regex::Matcher reg(expression);
+    std::vector<uint64_t> buffer = Serialized(reg);
+    DFAView view(AsBytes(buffer));
+
+    for (int i = 0; i < 100; ++i) {
+      std::string text(i % 7, 'a');
+      for (char &c : text)
+        c = static_cast<char>(letter(gen));
+
+      ASSERT_EQ(view.Match(text), reg.Match(text))
+          << expression << " on " << text;
+    }
+  }
+}
+
+TEST(DFAFileTests, OtherEnginesSaveTheSameLanguage) {
+  Regex::Matcher dfa("(a|b)*abb");
+  Regex::Matcher nfa("(a|b)*abb", Regex::Engine::Nfa);
+
+  ASSERT_EQ(Serialized(dfa), Serialized(nfa));
+}
+
+TEST(DFAFileTests, RejectsCorruptFiles) {
+  std::vector<uint64_t> buffer = Serialized(Regex::Matcher("ab*"));
+
+  // Truncated
+  ASSERT_THROW(DFAView(AsBytes(buffer).first(buffer.size() * 8 - 8)),
+               DFAFileError);
+  ASSERT_THROW(DFAView(AsBytes(buffer).first(16)), DFAFileError);
+
+  // Bad magic
+  std::vector<uint64_t> bad_magic = buffer;
+  bad_magic[0] ^= 1;
+  ASSERT_THROW(DFAView{AsBytes(bad_magic)}, DFAFileError);
+
+  // A transition past the last state
+  std::vector<uint64_t> bad_table = buffer;
+  const auto &header = *reinterpret_cast<const DFAFileHeader *>(buffer.data());
+  reinterpret_cast<uint32_t *>(bad_table.data())[header.table_offset / 4] =
+      1000;
+  ASSERT_THROW(DFAView{AsBytes(bad_table)}, DFAFileError);
+
+  ASSERT_NO_THROW(DFAView{AsBytes(buffer)});
+}
+
+TEST(DFAFileTests, MappedMatcher) {
+  const std::string path = TempPath("dfa_file_matcher");
+  {
+    std::ofstream out(path, std::ios::binary);
+    Regex::Matcher("(cat|dog)s*").Save(out);
+  }
+
+  Regex::MappedMatcher reg(path);
+  ASSERT_TRUE(reg.Match("cat"));
+  ASSERT_TRUE(reg.Match("dogss"));
+  ASSERT_FALSE(reg.Match("cow"));
+  ASSERT_FALSE(reg.Match(""));
+
+  std::remove(path.c_str());
+
+  ASSERT_THROW(Regex::MappedMatcher("/nonexistent/dfa"), DFAFileError);
+}
+
+TEST(DFAFileTests, MappedFileMoves) {
+  const std::string first = TempPath("dfa_file_first");
+  const std::string second = TempPath("dfa_file_second");
+  std::ofstream(first, std::ios::binary) << "first file";
+  std::ofstream(second, std::ios::binary) << "second";
+
+  MappedFile file(first);
+  MappedFile other(second);
+  file = std::move(other);
+  ASSERT_EQ(file.Bytes().size(), 6);
+  ASSERT_TRUE(other.Bytes().empty());
+
+  MappedFile moved(std::move(file));
+  ASSERT_EQ(moved.Bytes().size(), 6);
+  ASSERT_EQ(std::memcmp(moved.Bytes().data(), "second", 6), 0);
+  ASSERT_TRUE(file.Bytes().empty());
+
+  std::remove(first.c_str());
+  std::remove(second.c_str());
+}
+
+TEST(DFAFileTests, MappedPatternSet) {
+  const std::string path = TempPath("dfa_file_set");
+  {
+    std::ofstream out(path, std::ios::binary);
+    Regex::PatternSet{"a*b", "ab", "(a|b)*"}.Save(out);
+  }
+
+  Regex::MappedMatcher set(path);
+  std::span<const uint64_t> ids = set.MatchPatterns("ab");
+  ASSERT_EQ(std::vector<uint64_t>(ids.begin(), ids.end()),
+            (std::vector<uint64_t>{0, 1, 2}));
+  ASSERT_TRUE(set.MatchPatterns("ba").size() == 1);
+  ASSERT_TRUE(set.MatchPatterns("c").empty());
+
+  std::remove(path.c_str());
+}
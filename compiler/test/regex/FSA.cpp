@@ -2,7 +2,11 @@
 
 #include <algorithm>
 #include <execution>
+#include <string>
+#include <string_view>
+#include <vector>
 
+#include "Common.hpp"
 #include "regex/FSA.hpp"
 
 TEST(FSATests, ConsumeStringEvenNumberOfOnes) {
@@ -94,3 +98,168 @@ TEST(FSATests, UnionTest) {
   ASSERT_FALSE(fsa3.ConsumeString({0, 0}));
   ASSERT_FALSE(fsa3.ConsumeString({}));
 }
+
+namespace {
+
+FSA Compile(std::string_view expression) {
+  FSA fsa = Parse(expression);
+  fsa.Determinize();
+  return fsa;
+}
+
+// Every string over the alphabet up to the given length
+std::vector<std::vector<int64_t>> AllStrings(std::string_view alphabet,
+                                             size_t max_length) {
+  std::vector<std::vector<int64_t>> res{{}};
+
+  for (size_t begin = 0; begin < res.size(); ++begin) {
+    if (res[begin].size() == max_length)
+      continue;
+
+    for (char c : alphabet) {
+      std::vector<int64_t> next = res[begin];
+      next.push_back(c);
+      res.push_back(next);
+    }
+  }
+
+  return res;
+}
+
+} // namespace
+
+TEST(FSATests, MinimizePreservesLanguage) {
+  for (std::string_view expression :
+       {"a*b(c|d)", "(a|b)*abb", "cat|(dog)*", "(ab|ac|ad)(b|c)*", "a*a*a",
+        "((a|b)(a|b))*", "abc|abd|abcd"}) {
+    FSA dfa = Compile(expression);
+    FSA minimal = dfa;
+    minimal.Minimize();
+
+    ASSERT_LE(minimal.NumStates(), dfa.NumStates()) << expression;
+
+    for (const auto &str : AllStrings("abcdgot", 5)) {
+      ASSERT_EQ(dfa.ConsumeString(str), minimal.ConsumeString(str))
+          << expression;
+    }
+  }
+}
+
+TEST(FSATests, MinimizeStateCount) {
+  // Textbook example, the minimal DFA has 4 states
+  FSA fsa = Compile("(a|b)*abb");
+  fsa.Minimize();
+  ASSERT_EQ(fsa.NumStates(), 4);
+
+  // Alternatives with a common suffix collapse to one chain
+  FSA alternation = Compile("(ab|cb|db)");
+  alternation.Minimize();
+  ASSERT_EQ(alternation.NumStates(), 3);
+
+  // Minimizing twice changes nothing
+  FSA again = fsa;
+  again.Minimize();
+  ASSERT_EQ(again.NumStates(), fsa.NumStates());
+}
+
+TEST(FSATests, MinimizeEmptyLanguage) {
+  FSA fsa;
+  fsa.AddStates(3);
+  fsa.AddTransition(0, 1, 0);
+  fsa.AddTransition(1, 2, 1);
+  fsa.Minimize();
+
+  ASSERT_EQ(fsa.NumStates(), 1);
+  ASSERT_TRUE(fsa.Empty());
+  ASSERT_FALSE(fsa.ConsumeString({}));
+  ASSERT_FALSE(fsa.ConsumeString({0, 1}));
+}
+
+// A class is one range transition, and determinizing overlapping ranges cuts
+// them at the overlap without splitting them any further
+TEST(FSATests, RangeTransitions) {
+  FSA digits = Compile("[0-9]");
+  ASSERT_EQ(digits.TransitionsFrom(digits.StartState()).size(), 1);
+
+  FSA overlap = Compile("[a-m]x|[h-z]y");
+  ASSERT_EQ(overlap.TransitionsFrom(overlap.StartState()).size(), 3);
+  ASSERT_TRUE(overlap.ConsumeString({'a', 'x'}));
+  ASSERT_TRUE(overlap.ConsumeString({'k', 'x'}));
+  ASSERT_TRUE(overlap.ConsumeString({'k', 'y'}));
+  ASSERT_TRUE(overlap.ConsumeString({'z', 'y'}));
+  ASSERT_FALSE(overlap.ConsumeString({'a', 'y'}));
+  ASSERT_FALSE(overlap.ConsumeString({'z', 'x'}));
+
+  FSA minimal = overlap;
+  minimal.Minimize();
+  for (const auto &str : AllStrings("ahmnzxy", 3))
+    ASSERT_EQ(overlap.ConsumeString(str), minimal.ConsumeString(str));
+}
+
+// x{1,n} nests its optional copies, so determinizing it stays linear in n
+TEST(FSATests, CountedRepetitionSize) {
+  FSA fsa = Compile("[0-9]{1,64}");
+  ASSERT_EQ(fsa.NumStates(), 65);
+
+  fsa.Minimize();
+  ASSERT_EQ(fsa.NumStates(), 65);
+
+  std::vector<int64_t> str;
+  for (int i = 1; i <= 65; ++i) {
+    str.push_back('0' + i % 10);
+    ASSERT_EQ(fsa.ConsumeString(str), i <= 64);
+  }
+}
+
+// Many alternatives sharing prefixes. Every word must still be accepted and
+// nothing else, which fails if distinct subsets get merged
+TEST(FSATests, DeterminizeManyAlternatives) {
+  std::vector<std::string> words;
+  for (const auto &str : AllStrings("abc", 3)) {
+    if (str.size() == 3 && str[1] != 'b')
+      words.emplace_back(str.begin(), str.end());
+  }
+
+  std::string expression;
+  for (const std::string &word : words)
+    expression += (expression.empty() ? "" : "|") + word;
+
+  FSA fsa = Compile(expression);
+
+  for (const auto &str : AllStrings("abc", 4)) {
+    const std::string word(str.begin(), str.end());
+    bool is_word = std::find(words.begin(), words.end(), word) != words.end();
+    ASSERT_EQ(fsa.ConsumeString(str), is_word);
+  }
+}
+
+TEST(FSATests, EpsilonClosures) {
+  // 0 -> 1 <-> 2 -> 3, 1 -b-> 3, 3 -a-> 4, 4 -> 0, 4 accepts. 0 and 2 only
+  // have epsilon transitions out so they aren't part of any closure.
+  FSA fsa;
+  fsa.AddStates(5);
+  fsa.AddTransition(0, 1, FSA::Eps);
+  fsa.AddTransition(1, 2, FSA::Eps);
+  fsa.AddTransition(1, 3, 'b');
+  fsa.AddTransition(2, 1, FSA::Eps);
+  fsa.AddTransition(2, 3, FSA::Eps);
+  fsa.AddTransition(3, 4, 'a');
+  fsa.AddTransition(4, 0, FSA::Eps);
+  fsa.AcceptState(4);
+
+  FSA::Closures closures = fsa.EpsilonClosures();
+
+  auto closure = [&](uint64_t state) {
+    return std::vector<uint64_t>(closures[state].begin(),
+                                 closures[state].end());
+  };
+
+  ASSERT_EQ(closure(0), (std::vector<uint64_t>{1, 3}));
+  ASSERT_EQ(closure(1), (std::vector<uint64_t>{1, 3}));
+  ASSERT_EQ(closure(2), (std::vector<uint64_t>{1, 3}));
+  ASSERT_EQ(closure(3), (std::vector<uint64_t>{3}));
+  ASSERT_EQ(closure(4), (std::vector<uint64_t>{1, 3, 4}));
+
+  // States in one component share their closure
+  ASSERT_EQ(closures[1].data(), closures[2].data());
+}
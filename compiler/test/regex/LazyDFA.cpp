@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "Common.hpp"
+#include "regex/LazyDFA.hpp"
+#include "regex/Regex.hpp"
+
+namespace {
+
+// (a|b)*a(a|b)^n, i.e. the (n+1)th symbol from the end is an a. The full DFA
+// needs 2^(n+1) states
+std::string NthFromEnd(int n) {
+  std::string expression = "(a|b)*a";
+  for (int i = 0; i < n; ++i)
+    expression += "(a|b)";
+  return expression;
+}
+
+std::string RandomAb(std::mt19937 &gen, size_t length) {
+  std::uniform_int_distribution<int> coin(0, 1);
+  std::string res(length, 'a');
+  for (char &c : res)
+    c = coin(gen) ? 'a' : 'b';
+  return res;
+}
+
+} // namespace
+
+TEST(LazyDFATests, SimpleExpr) {
+  LazyDFA dfa{Parse("a*b(c|d)")};
+
+  ASSERT_TRUE(dfa.Match("abd"));
+  ASSERT_TRUE(dfa.Match("aabc"));
+  ASSERT_TRUE(dfa.Match("bd"));
+  ASSERT_FALSE(dfa.Match("ad"));
+  ASSERT_FALSE(dfa.Match("aaabdsod"));
+
+  // Second time around everything comes from the cache
+  const uint64_t cached = dfa.NumCachedStates();
+  ASSERT_TRUE(dfa.Match("aabc"));
+  ASSERT_EQ(dfa.NumCachedStates(), cached);
+  ASSERT_EQ(dfa.NumFlushes(), 0);
+}
+
+// Would need 2^21 states up front, but the input only ever visits a few
+TEST(LazyDFATests, ExponentialPattern) {
+  constexpr int n = 20;
+  LazyDFA dfa{Parse(NthFromEnd(n))};
+
+  std::mt19937 gen(1);
+  for (int i = 0; i < 200; ++i) {
+    std::string input = RandomAb(gen, n + 1 + i);
+    ASSERT_EQ(dfa.Match(input), input[input.size() - n - 1] == 'a');
+  }
+
+  ASSERT_LE(dfa.NumCachedStates(), LazyDFA::DefaultCapacity);
+}
+
+// A tiny cache keeps getting flushed, and eventually gives up on caching and
+// simulates the NFA. The answers have to stay the same throughout.
+TEST(LazyDFATests, BoundedCache) {
+  constexpr int n = 6;
+  LazyDFA dfa{Parse(NthFromEnd(n)), 8};
+
+  std::mt19937 gen(2);
+  for (int i = 0; i < 200; ++i) {
+    std::string input = RandomAb(gen, n + 1 + i);
+    ASSERT_EQ(dfa.Match(input), input[input.size() - n - 1] == 'a');
+    ASSERT_LE(dfa.NumCachedStates(), 8);
+  }
+
+  ASSERT_GT(dfa.NumFlushes(), 0);
+  ASSERT_GT(dfa.NumFallbacks(), 0);
+}
+
+TEST(LazyDFATests, MatcherEngine) {
+  Regex::Matcher reg("cat|(dog)*", Regex::Engine::LazyDfa);
+
+  ASSERT_TRUE(reg.Match("cat"));
+  ASSERT_TRUE(reg.Match(""));
+  ASSERT_TRUE(reg.Match("dogdogdogdog"));
+  ASSERT_FALSE(reg.Match("dogcat"));
+  ASSERT_FALSE(reg.Match("catcat"));
+
+  Regex::Matcher exponential(NthFromEnd(24), Regex::Engine::LazyDfa);
+  ASSERT_TRUE(exponential.Match("b" + std::string(25, 'a')));
+  ASSERT_FALSE(exponential.Match("b" + std::string(25, 'b')));
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "regex/Regex.hpp"
+
+// Every way of cutting the input in two or three gives the same answer
+TEST(MatchStateTests, AgreesWithMatch) {
+  std::mt19937 gen(15);
+  std::uniform_int_distribution<int> letter('a', 'c');
+
+  for (std::string_view expression : {"(a|b)*abb", "a*b(c|a)", "(ab|c)*", ""}) {
+    Regex::Matcher reg(expression);
+
+    for (int n = 0; n < 50; ++n) {
+      std::string text(n % 9, 'a');
+      for (char &c : text)
+        c = static_cast<char>(letter(gen));
+      std::string_view view = text;
+
+      for (size_t i = 0; i <= text.size(); ++i) {
+        for (size_t j = i; j <= text.size(); ++j) {
+          MatchState stream = reg.Stream();
+          stream.Feed(view.substr(0, i));
+          stream.Feed(view.substr(i, j - i));
+          stream.Feed(view.substr(j));
+
+          ASSERT_EQ(stream.Finish(), reg.Match(text))
+              << expression << " on " << text << " cut at " << i << ", " << j;
+        }
+      }
+    }
+  }
+}
+
+TEST(MatchStateTests, StopsWhenDead) {
+  Regex::Matcher reg("ab*c");
+  MatchState stream = reg.Stream();
+
+  ASSERT_TRUE(stream.Feed("ab"));
+  ASSERT_TRUE(stream.Feed("bb"));
+  ASSERT_FALSE(stream.Finish());
+  ASSERT_FALSE(stream.Feed("bcx"));
+  ASSERT_TRUE(stream.Dead());
+  ASSERT_FALSE(stream.Feed("c"));
+  ASSERT_FALSE(stream.Finish());
+
+  stream.Reset();
+  ASSERT_TRUE(stream.Feed("a"));
+  ASSERT_TRUE(stream.Feed("c"));
+  ASSERT_TRUE(stream.Finish());
+}
+
+// Engines without a DFA of their own build one for streaming
+TEST(MatchStateTests, OtherEngines) {
+  for (Regex::Engine engine : {Regex::Engine::LazyDfa, Regex::Engine::Nfa}) {
+    Regex::Matcher reg("(cat|dog)s*", engine);
+    MatchState stream = reg.Stream();
+
+    ASSERT_TRUE(stream.Feed("do"));
+    ASSERT_TRUE(stream.Feed("gss"));
+    ASSERT_TRUE(stream.Finish());
+    ASSERT_TRUE(reg.Match("dogss"));
+  }
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "regex/FSA.hpp"
+#include "regex/NFABuilder.hpp"
+
+namespace {
+
+NFABuilder::Fragment Symbol(NFABuilder &nfa, int64_t label) {
+  const NFABuilder::Mark mark = nfa.Here();
+  const uint64_t start = nfa.AddStates(2);
+  nfa.AddTransition(start, start + 1, label);
+  return nfa.Since(mark, start, start + 1);
+}
+
+} // namespace
+
+TEST(NFABuilderTests, Concatenate) {
+  NFABuilder nfa;
+  NFABuilder::Fragment ab = Symbol(nfa, 'a');
+  ab = nfa.Concatenate(ab, Symbol(nfa, 'b'));
+  ab = nfa.Concatenate(ab, NFABuilder::Fragment{});
+
+  FSA fsa = nfa.Finish(ab);
+  // Joining two fragments only adds an epsilon transition between them
+  ASSERT_EQ(fsa.NumStates(), 4);
+
+  fsa.Determinize();
+  ASSERT_TRUE(fsa.ConsumeString({'a', 'b'}));
+  ASSERT_FALSE(fsa.ConsumeString({'a'}));
+  ASSERT_FALSE(fsa.ConsumeString({'b'}));
+}
+
+// However many branches, they hang off one start state
+TEST(NFABuilderTests, AlternateIsFlat) {
+  NFABuilder nfa;
+  std::vector<NFABuilder::Fragment> branches;
+  for (int64_t label = 'a'; label <= 'z'; ++label)
+    branches.push_back(Symbol(nfa, label));
+
+  const NFABuilder::Fragment any = nfa.Alternate(branches);
+  FSA fsa = nfa.Finish(any);
+  ASSERT_EQ(fsa.TransitionsFrom(fsa.StartState()).size(), 26);
+
+  fsa.Determinize();
+  for (int64_t label = 'a'; label <= 'z'; ++label)
+    ASSERT_TRUE(fsa.ConsumeString({label}));
+  ASSERT_FALSE(fsa.ConsumeString({'a', 'a'}));
+}
+
+TEST(NFABuilderTests, RepeatCopiesFragment) {
+  NFABuilder nfa;
+  NFABuilder::Fragment ab = Symbol(nfa, 'a');
+  ab = nfa.Concatenate(ab, Symbol(nfa, 'b'));
+  const NFABuilder::Fragment repeated = nfa.Repeat(ab, 1, 3);
+
+  // The fragment is the first copy, then two more and a start and final state
+  FSA fsa = nfa.Finish(repeated);
+  ASSERT_EQ(fsa.NumStates(), 3 * 4 + 2);
+
+  fsa.Determinize();
+  ASSERT_FALSE(fsa.ConsumeString({}));
+  ASSERT_TRUE(fsa.ConsumeString({'a', 'b'}));
+  ASSERT_TRUE(fsa.ConsumeString({'a', 'b', 'a', 'b', 'a', 'b'}));
+  ASSERT_FALSE(fsa.ConsumeString({'a', 'b', 'a', 'b', 'a', 'b', 'a', 'b'}));
+  ASSERT_FALSE(fsa.ConsumeString({'a', 'b', 'a'}));
+}
+
+// Finishing hands the arena over, leaving the builder ready for a new pattern
+TEST(NFABuilderTests, FinishResets) {
+  NFABuilder nfa;
+  FSA first = nfa.Finish(nfa.Closure(Symbol(nfa, 'a')));
+  FSA second = nfa.Finish(Symbol(nfa, 'b'));
+
+  ASSERT_EQ(second.NumStates(), 2);
+  ASSERT_EQ(nfa.Finish(NFABuilder::Fragment{}).NumStates(), 0);
+
+  first.Determinize();
+  second.Determinize();
+  ASSERT_TRUE(first.ConsumeString({'a', 'a'}));
+  ASSERT_TRUE(second.ConsumeString({'b'}));
+  ASSERT_FALSE(second.ConsumeString({'a'}));
+}
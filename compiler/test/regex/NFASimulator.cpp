@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "Common.hpp"
+#include "regex/NFASimulator.hpp"
+#include "regex/Regex.hpp"
+#include "regex/SparseSet.hpp"
+
+TEST(SparseSetTests, InsertContainsClear) {
+  SparseSet set(8);
+
+  ASSERT_TRUE(set.Empty());
+  ASSERT_TRUE(set.Insert(5));
+  ASSERT_TRUE(set.Insert(2));
+  ASSERT_FALSE(set.Insert(5));
+  ASSERT_TRUE(set.Contains(2));
+  ASSERT_FALSE(set.Contains(3));
+  ASSERT_EQ(set.Size(), 2);
+
+  // Insertion order
+  ASSERT_EQ(*set.begin(), 5);
+
+  set.Clear();
+  ASSERT_TRUE(set.Empty());
+  ASSERT_FALSE(set.Contains(5));
+  ASSERT_TRUE(set.Insert(2));
+  ASSERT_FALSE(set.Contains(5));
+}
+
+TEST(NFASimulatorTests, SimpleExpr) {
+  NFASimulator nfa{Parse("a*b(c|d)")};
+
+  ASSERT_TRUE(nfa.Match("abd"));
+  ASSERT_TRUE(nfa.Match("aabc"));
+  ASSERT_TRUE(nfa.Match("bd"));
+  ASSERT_FALSE(nfa.Match("ad"));
+  ASSERT_FALSE(nfa.Match("aaabdsod"));
+}
+
+// Nested closures give epsilon cycles and, for a backtracking matcher,
+// exponentially many ways to split the input
+TEST(NFASimulatorTests, NestedClosure) {
+  NFASimulator nfa{Parse("(a*)*b")};
+
+  ASSERT_TRUE(nfa.Match("aaab"));
+  ASSERT_TRUE(nfa.Match("b"));
+  ASSERT_FALSE(nfa.Match(std::string(10000, 'a')));
+  ASSERT_TRUE(nfa.Match(std::string(10000, 'a') + "b"));
+}
+
+// Long inputs must not recurse
+TEST(NFASimulatorTests, LongInput) {
+  NFASimulator nfa{Parse("(a|b)*a(a|b)")};
+
+  std::string input(1 << 17, 'b');
+  ASSERT_FALSE(nfa.Match(input));
+
+  input[input.size() - 2] = 'a';
+  ASSERT_TRUE(nfa.Match(input));
+}
+
+TEST(NFASimulatorTests, MatcherEngine) {
+  Regex::Matcher reg("d(a|b)*", Regex::Engine::Nfa);
+
+  ASSERT_TRUE(reg.Match("d"));
+  ASSERT_TRUE(reg.Match("dabababba"));
+  ASSERT_FALSE(reg.Match("aad"));
+  ASSERT_FALSE(reg.Match("dadbdbdada"));
+
+  Regex::Matcher greedy("a*a", Regex::Engine::Nfa);
+  ASSERT_TRUE(greedy.Match("aaa"));
+  ASSERT_FALSE(greedy.Match(""));
+}
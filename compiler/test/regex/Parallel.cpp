@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "regex/Parallel.hpp"
+#include "regex/Regex.hpp"
+
+namespace {
+
+std::string RandomText(std::mt19937 &gen, size_t length) {
+  std::uniform_int_distribution<int> letter('a', 'd');
+  std::string res(length, 'a');
+  for (char &c : res)
+    c = static_cast<char>(letter(gen));
+  return res;
+}
+
+} // namespace
+
+// Every state's run over a chunk, checked one state at a time
+TEST(ParallelTests, ChunkMap) {
+  FSA fsa;
+  fsa.AddStates(3);
+  fsa.AddTransition(0, 1, 'a');
+  fsa.AddTransition(1, 2, 'b');
+  fsa.AddTransition(2, 0, 'a');
+  fsa.AddTransition(2, 2, 'b');
+  fsa.AcceptState(2);
+  DFA dfa{fsa};
+
+  std::mt19937 gen(13);
+  for (size_t length : {0, 1, 5, 16, 17, 100}) {
+    std::string text = RandomText(gen, length);
+    std::span<const uint8_t> bytes(
+        reinterpret_cast<const uint8_t *>(text.data()), text.size());
+
+    Parallel::ChunkMap forward(dfa, bytes, false);
+    Parallel::ChunkMap backward(dfa, bytes, true);
+
+    for (uint32_t state = 0; state < dfa.NumStates(); ++state) {
+      uint32_t expected = state;
+      for (uint8_t byte : bytes)
+        expected = dfa.Next(expected, byte);
+      ASSERT_EQ(forward(state), expected) << text;
+
+      expected = state;
+      for (size_t i = bytes.size(); i-- > 0;)
+        expected = dfa.Next(expected, bytes[i]);
+      ASSERT_EQ(backward(state), expected) << text;
+    }
+  }
+}
+
+TEST(ParallelTests, MatchAgreesWithSerial) {
+  std::mt19937 gen(14);
+
+  for (std::string_view expression :
+       {"(a|b|c|d)*abc(a|b|c|d)*", "(a|b)*", "((a|b|c|d)(a|b|c|d))*", ""}) {
+    Regex::Matcher reg(expression);
+
+    for (size_t length : {0, 63, 64, 65, 200, 1000}) {
+      std::string text = RandomText(gen, length);
+
+      for (uint64_t chunk_size : {1, 64, 128})
+        ASSERT_EQ(reg.ParallelMatch(text, chunk_size), reg.Match(text))
+            << expression << " chunks of " << chunk_size << " on " << text;
+    }
+  }
+}
+
+TEST(ParallelTests, FindAllAgreesWithSerial) {
+  std::mt19937 gen(15);
+
+  for (std::string_view expression :
+       {"a*b(c|d)", "(a|b)*c", "ab|b|bcd", "d*", "abcd(a|b|c|d)*"}) {
+    Regex::Matcher reg(expression);
+
+    for (size_t length : {0, 63, 64, 65, 300, 2000}) {
+      std::string text = RandomText(gen, length);
+
+      for (uint64_t chunk_size : {1, 64, 192})
+        ASSERT_EQ(reg.ParallelFindAll(text, chunk_size), reg.FindAll(text))
+            << expression << " chunks of " << chunk_size << " on " << text;
+    }
+  }
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "regex/PatternSet.hpp"
+#include "regex/Regex.hpp"
+
+namespace {
+
+std::vector<uint64_t> Ids(std::span<const uint64_t> ids) {
+  return {ids.begin(), ids.end()};
+}
+
+} // namespace
+
+TEST(PatternSetTests, ReportsEveryMatch) {
+  Regex::PatternSet set{"a*b", "ab", "(a|b)*", "cat|dog", ""};
+
+  ASSERT_EQ(set.Size(), 5);
+  ASSERT_EQ(Ids(set.Match("ab")), (std::vector<uint64_t>{0, 1, 2}));
+  ASSERT_EQ(Ids(set.Match("aab")), (std::vector<uint64_t>{0, 2}));
+  ASSERT_EQ(Ids(set.Match("")), (std::vector<uint64_t>{2}));
+  ASSERT_EQ(Ids(set.Match("dog")), (std::vector<uint64_t>{3}));
+  ASSERT_TRUE(set.Match("dab").empty());
+
+  ASSERT_TRUE(set.MatchAny("cat"));
+  ASSERT_FALSE(set.MatchAny("cab"));
+}
+
+// Minimization would merge the accept states of "a" and "b" if it ignored
+// which pattern they belong to
+TEST(PatternSetTests, MinimizeKeepsPatternsApart) {
+  Regex::PatternSet set{"a", "b", "a|b"};
+
+  ASSERT_EQ(Ids(set.Match("a")), (std::vector<uint64_t>{0, 2}));
+  ASSERT_EQ(Ids(set.Match("b")), (std::vector<uint64_t>{1, 2}));
+}
+
+TEST(PatternSetTests, Empty) {
+  Regex::PatternSet none{};
+  ASSERT_TRUE(none.Match("").empty());
+  ASSERT_FALSE(none.MatchAny("a"));
+
+  Regex::PatternSet empty_patterns{"", ""};
+  ASSERT_TRUE(empty_patterns.Match("").empty());
+}
+
+TEST(PatternSetTests, ParseError) {
+  ASSERT_THROW((Regex::PatternSet{"a", "(b"}), Regex::ParseError);
+}
+
+TEST(PatternSetTests, AgreesWithMatchers) {
+  std::vector<std::string_view> patterns{
+      "a*b(c|d)", "(a|b)*c", "ab|b|bcd", "(ab)*", "a(b|c)*d|c", "d*", "abcd",
+  };
+
+  Regex::PatternSet set(patterns);
+  std::vector<Regex::Matcher> matchers;
+  for (std::string_view pattern : patterns)
+    matchers.emplace_back(pattern);
+
+  std::mt19937 gen(5);
+  std::uniform_int_distribution<int> letter('a', 'd');
+
+  for (int i = 0; i < 500; ++i) {
+    std::string input(i % 7, 'a');
+    for (char &c : input)
+      c = static_cast<char>(letter(gen));
+
+    std::vector<uint64_t> expected;
+    for (uint64_t id = 0; id < matchers.size(); ++id) {
+      if (matchers[id].Match(input))
+        expected.push_back(id);
+    }
+
+    ASSERT_EQ(Ids(set.Match(input)), expected) << input;
+  }
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Common.hpp"
+#include "regex/Prefilter.hpp"
+#include "regex/Regex.hpp"
+
+namespace {
+
+Prefilter Build(std::string_view expression) {
+  return Prefilter(Parse(expression));
+}
+
+std::span<const uint8_t> Bytes(std::string_view str) {
+  return {reinterpret_cast<const uint8_t *>(str.data()), str.size()};
+}
+
+std::vector<uint8_t> Vec(std::string_view str) {
+  return {str.begin(), str.end()};
+}
+
+} // namespace
+
+TEST(PrefilterTests, FirstBytesAndLiteral) {
+  Prefilter lit = Build("needle(s|d)");
+  ASSERT_TRUE(lit.Active());
+  ASSERT_EQ(std::vector<uint8_t>(lit.Bytes().begin(), lit.Bytes().end()),
+            Vec("n"));
+  ASSERT_EQ(std::vector<uint8_t>(lit.Literal().begin(), lit.Literal().end()),
+            Vec("needle"));
+
+  Prefilter alt = Build("cat|dog");
+  ASSERT_EQ(std::vector<uint8_t>(alt.Bytes().begin(), alt.Bytes().end()),
+            Vec("cd"));
+  ASSERT_TRUE(alt.Literal().empty());
+
+  // Single byte prefixes are scanned for as bytes
+  ASSERT_TRUE(Build("a(b|c)").Literal().empty());
+}
+
+TEST(PrefilterTests, Inactive) {
+  // Empty matches
+  ASSERT_FALSE(Build("a*").Active());
+  ASSERT_FALSE(Build("").Active());
+  // Too many first bytes
+  ASSERT_FALSE(Build("a|b|c|d").Active());
+
+  Prefilter none;
+  ASSERT_EQ(none.Next(Bytes("abc"), 1), 1);
+  ASSERT_EQ(none.Prev(Bytes("abc"), 0, 2), 1);
+}
+
+// Positions straddling the 16 and 32 byte blocks, compared to a plain loop
+TEST(PrefilterTests, AgreesWithScalar) {
+  std::mt19937 gen(10);
+  std::uniform_int_distribution<int> letter('a', 'h');
+
+  for (std::string_view expression : {"ab(c|d)", "e|fg", "abcabd", "h"}) {
+    Prefilter filter = Build(expression);
+    ASSERT_TRUE(filter.Active()) << expression;
+    Regex::Matcher reg(expression);
+    const std::string first(filter.Bytes().begin(), filter.Bytes().end());
+    const std::string literal(filter.Literal().begin(), filter.Literal().end());
+
+    for (size_t length = 0; length < 100; ++length) {
+      std::string text(length, 'a');
+      for (char &c : text)
+        c = static_cast<char>(letter(gen));
+      std::span<const uint8_t> input = Bytes(text);
+
+      for (size_t from = 0; from <= length; from += 7) {
+        // The literal must occur at the position, any first byte otherwise
+        size_t expected = length;
+        for (size_t i = from; i < length; ++i) {
+          if (literal.empty() ? first.find(text[i]) != std::string::npos
+                              : text.compare(i, literal.size(), literal) == 0) {
+            expected = i;
+            break;
+          }
+        }
+        ASSERT_EQ(filter.Next(input, from), expected)
+            << expression << " on " << text << " from " << from;
+
+        size_t expected_prev = SIZE_MAX;
+        for (size_t i = length; i-- > from;) {
+          if (first.find(text[i]) != std::string::npos) {
+            expected_prev = i;
+            break;
+          }
+        }
+        ASSERT_EQ(filter.Prev(input, from, length), expected_prev)
+            << expression << " on " << text << " from " << from;
+      }
+
+      // The prefilter never skips a match
+      std::optional<MatchSpan> match = reg.Find(text);
+      if (match) {
+        ASSERT_LE(filter.Next(input, 0), match->begin);
+      }
+    }
+  }
+}
@@ -1,5 +1,11 @@
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "regex/Regex.hpp"
 
 TEST(RegexExprTests, UnterminatedParentheses) {
@@ -13,6 +19,39 @@ TEST(RegexExprTests, ClosureOfNothing) {
   ASSERT_THROW(Regex::Matcher("abcd()*"), Regex::ParseError);
 }
 
+TEST(RegexExprTests, BadRepetition) {
+  ASSERT_THROW(Regex::Matcher("+"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("(?)"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("{2}"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("a{"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("a{}"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("a{x}"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("a{2,1}"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("a{1,2"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("a{1001}"), Regex::ParseError);
+}
+
+TEST(RegexExprTests, BadClass) {
+  ASSERT_THROW(Regex::Matcher("[]"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("[abc"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("[z-a]"), Regex::ParseError);
+}
+
+// Stray closing brackets used to cut the pattern short, and empty branches
+// used to end the alternation
+TEST(RegexExprTests, LeftoverTokens) {
+  ASSERT_THROW(Regex::Matcher("a)b"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("ab]"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher(")"), Regex::ParseError);
+}
+
+TEST(RegexExprTests, EmptyAlternative) {
+  ASSERT_THROW(Regex::Matcher("a||b"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("a|"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("|a"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("(a|)b"), Regex::ParseError);
+}
+
 TEST(RegexMatcherTests, SimpleExpr) {
   Regex::Matcher reg("a*b(c|d)");
 
@@ -61,10 +100,75 @@ TEST(RegexMatcherTests, ClosureBeatsAlternation) {
   ASSERT_FALSE(reg.Match("catcat"));
 }
 
-TEST(RegexMatchTests, EmptyMatchesNothing) {
-  Regex::Matcher reg("");
+TEST(RegexMatcherTests, PlusAndOptional) {
+  Regex::Matcher reg("ab+c?");
+
+  ASSERT_TRUE(reg.Match("ab"));
+  ASSERT_TRUE(reg.Match("abbbc"));
+  ASSERT_FALSE(reg.Match("a"));
+  ASSERT_FALSE(reg.Match("ac"));
+  ASSERT_FALSE(reg.Match("abcc"));
+
+  // Postfix operators stack
+  Regex::Matcher stacked("(ab)?+");
+  ASSERT_TRUE(stacked.Match(""));
+  ASSERT_TRUE(stacked.Match("abab"));
+  ASSERT_FALSE(stacked.Match("aba"));
+}
+
+TEST(RegexMatcherTests, CountedRepetition) {
+  Regex::Matcher exact("a{3}");
+  ASSERT_TRUE(exact.Match("aaa"));
+  ASSERT_FALSE(exact.Match("aa"));
+  ASSERT_FALSE(exact.Match("aaaa"));
+
+  Regex::Matcher range("x(ab){1,3}");
+  ASSERT_FALSE(range.Match("x"));
+  ASSERT_TRUE(range.Match("xab"));
+  ASSERT_TRUE(range.Match("xababab"));
+  ASSERT_FALSE(range.Match("xabababab"));
+  ASSERT_FALSE(range.Match("xaba"));
+
+  Regex::Matcher at_least("a{2,}b");
+  ASSERT_FALSE(at_least.Match("ab"));
+  ASSERT_TRUE(at_least.Match("aab"));
+  ASSERT_TRUE(at_least.Match("aaaaaab"));
+
+  Regex::Matcher none("ba{0}c{0,0}");
+  ASSERT_TRUE(none.Match("b"));
+  ASSERT_FALSE(none.Match("ba"));
+}
+
+TEST(RegexMatcherTests, CharacterClasses) {
+  Regex::Matcher reg("[a-cx-z0-9]+");
+  ASSERT_TRUE(reg.Match("abcxyz0123456789"));
+  ASSERT_FALSE(reg.Match("d"));
+  ASSERT_FALSE(reg.Match("w"));
+  ASSERT_FALSE(reg.Match(""));
+
+  // A dash at either end, and anything but ], is literal inside a class
+  Regex::Matcher literal("[-a][b-][*|(]");
+  ASSERT_TRUE(literal.Match("-b*"));
+  ASSERT_TRUE(literal.Match("a-("));
+  ASSERT_FALSE(literal.Match("bb|"));
+
+  // Outside of one, so are dash, comma and closing brace
+  Regex::Matcher punctuation("a-b,c}");
+  ASSERT_TRUE(punctuation.Match("a-b,c}"));
+}
+
+class EngineTests : public testing::TestWithParam<Regex::Engine> {};
+
+INSTANTIATE_TEST_SUITE_P(Engines, EngineTests,
+                         testing::Values(Regex::Engine::Dfa,
+                                         Regex::Engine::LazyDfa,
+                                         Regex::Engine::Nfa));
+
+TEST_P(EngineTests, EmptyMatchesNothing) {
+  Regex::Matcher reg("", GetParam());
 
   ASSERT_FALSE(reg.Match("dj"));
+  ASSERT_FALSE(reg.Match("a"));
   ASSERT_FALSE(reg.Match(""));
 }
 
@@ -75,6 +179,41 @@ TEST(RegexMatcherTests, GreedyShouldGiveBack) {
   ASSERT_TRUE(reg.Match("aaa"));
 }
 
+// Alternatives sharing a prefix must not be merged into one DFA state
+TEST(RegexMatcherTests, SharedPrefix) {
+  Regex::Matcher reg("(a|b)*abb");
+
+  ASSERT_TRUE(reg.Match("abb"));
+  ASSERT_TRUE(reg.Match("babaabb"));
+  ASSERT_FALSE(reg.Match("ab"));
+  ASSERT_FALSE(reg.Match("abba"));
+  ASSERT_FALSE(reg.Match("abab"));
+}
+
+// Large enough to be split across threads, with inputs of every length
+TEST(RegexMatcherTests, MatchBatch) {
+  std::mt19937 gen(14);
+  std::uniform_int_distribution<int> letter('a', 'c');
+  std::uniform_int_distribution<int> length(0, 12);
+
+  std::vector<std::string> strings(10000);
+  for (std::string &str : strings) {
+    str.resize(length(gen));
+    for (char &c : str)
+      c = static_cast<char>(letter(gen));
+  }
+  std::vector<std::string_view> inputs(strings.begin(), strings.end());
+
+  for (Regex::Engine engine : {Regex::Engine::Dfa, Regex::Engine::Nfa}) {
+    Regex::Matcher reg("(a|b)*abb(c)*", engine);
+    auto results = std::make_unique<bool[]>(inputs.size());
+    reg.MatchBatch(inputs, {results.get(), inputs.size()});
+
+    for (size_t i = 0; i < inputs.size(); ++i)
+      ASSERT_EQ(results[i], reg.Match(inputs[i])) << inputs[i];
+  }
+}
+
 
 
 
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Common.hpp"
+#include "regex/Regex.hpp"
+#include "regex/Search.hpp"
+
+namespace {
+
+// Leftmost-longest by trying every substring against the whole-string matcher
+std::vector<MatchSpan> BruteForce(Regex::Matcher &reg, std::string_view str) {
+  std::vector<MatchSpan> res;
+  std::optional<size_t> last_end;
+
+  for (size_t begin = 0; begin <= str.size();) {
+    std::optional<size_t> end;
+    for (size_t e = begin; e <= str.size(); ++e) {
+      if (reg.Match(str.substr(begin, e - begin)))
+        end = e;
+    }
+
+    if (!end || (*end == begin && last_end == begin)) {
+      ++begin;
+      continue;
+    }
+
+    res.push_back({begin, *end});
+    last_end = *end;
+    begin = *end > begin ? *end : begin + 1;
+  }
+
+  return res;
+}
+
+} // namespace
+
+TEST(SearchTests, Find) {
+  Regex::Matcher reg("a*b(c|d)");
+
+  ASSERT_EQ(reg.Find("xxabdyy"), (MatchSpan{2, 5}));
+  ASSERT_EQ(reg.Find("bcaaabd"), (MatchSpan{0, 2}));
+  ASSERT_EQ(reg.Find("xaaabdbc"), (MatchSpan{1, 6}));
+  ASSERT_EQ(reg.Find("abxbe"), std::nullopt);
+  ASSERT_EQ(reg.Find(""), std::nullopt);
+}
+
+// The match that starts first wins even if another one ends earlier
+TEST(SearchTests, LeftmostBeatsEarliestEnd) {
+  Regex::Matcher reg("abcd|b");
+
+  ASSERT_EQ(reg.Find("abcd"), (MatchSpan{0, 4}));
+  ASSERT_EQ(reg.Find("abce"), (MatchSpan{1, 2}));
+}
+
+TEST(SearchTests, LongestWins) {
+  Regex::Matcher reg("a|ab|abc");
+
+  ASSERT_EQ(reg.FindAll("abcabxa"),
+            (std::vector<MatchSpan>{{0, 3}, {3, 5}, {6, 7}}));
+}
+
+TEST(SearchTests, EmptyMatches) {
+  Regex::Matcher reg("a*");
+
+  ASSERT_EQ(reg.FindAll("baab"),
+            (std::vector<MatchSpan>{{0, 0}, {1, 3}, {4, 4}}));
+
+  Regex::Matcher nothing("");
+  ASSERT_TRUE(nothing.FindAll("abc").empty());
+  ASSERT_EQ(nothing.Find("abc"), std::nullopt);
+}
+
+TEST(SearchTests, MatchesRange) {
+  Regex::Matcher reg("dog|cat");
+  std::string text = "hotdog catalog dogma";
+
+  std::vector<std::string> found;
+  for (const MatchSpan &match : reg.Matches(text))
+    found.push_back(text.substr(match.begin, match.end - match.begin));
+
+  ASSERT_EQ(found, (std::vector<std::string>{"dog", "cat", "dog"}));
+}
+
+// Long input with matches spread across several bitmap words
+TEST(SearchTests, LongInput) {
+  Regex::Matcher reg("x(y)*");
+
+  std::string text(1000, '.');
+  text[3] = 'x';
+  text[500] = 'x';
+  text[501] = 'y';
+  text[502] = 'y';
+  text[999] = 'x';
+
+  ASSERT_EQ(reg.FindAll(text),
+            (std::vector<MatchSpan>{{3, 4}, {500, 503}, {999, 1000}}));
+}
+
+/*
+ * Every 'a' is a match start whose run goes on to the end of the input looking
+ * for a 'b', so following each start on its own would take about n^2 / 2
+ * steps. Windows of starts pay for the rest of the input once each instead
+ */
+TEST(SearchTests, StepsPerWindow) {
+  if constexpr (!StatsEnabled)
+    GTEST_SKIP() << "built with REGEX_STATS=0";
+
+  Regex::Matcher reg("a|a*b");
+  reg.CollectMatchStats(true);
+  const std::string text(16 * Searcher::Window, 'a');
+
+  const std::vector<MatchSpan> matches = reg.FindAll(text);
+  ASSERT_EQ(matches.size(), text.size());
+  ASSERT_EQ(matches.back(), (MatchSpan{text.size() - 1, text.size()}));
+
+  const uint64_t windows = text.size() / Searcher::Window;
+  ASSERT_LE(reg.Stats().match.steps, 2 * windows * text.size());
+}
+
+// Runs that die right after their match cost a constant number of steps
+TEST(SearchTests, StepsLinear) {
+  if constexpr (!StatsEnabled)
+    GTEST_SKIP() << "built with REGEX_STATS=0";
+
+  Regex::Matcher reg("[a-z]+");
+  reg.CollectMatchStats(true);
+
+  std::string text;
+  while (text.size() < (1 << 18))
+    text += "lorem ipsum dolor sit amet ";
+
+  ASSERT_EQ(reg.FindAll(text).size(), text.size() / 27 * 5);
+  ASSERT_LE(reg.Stats().match.steps, 2 * text.size());
+}
+
+// Nothing past the first window is looked at until the range gets there
+TEST(SearchTests, MatchesIsLazy) {
+  Regex::Matcher reg("[a-z]+");
+  std::string spaced(1 << 20, 'a');
+  for (size_t i = 0; i < spaced.size(); i += 2)
+    spaced[i] = ' ';
+
+  auto matches = reg.Matches(spaced);
+  ASSERT_EQ(*matches.begin(), (MatchSpan{1, 2}));
+  ASSERT_LE(matches.begin().Steps(), 2 * Searcher::Window);
+}
+
+// Across window boundaries, against Find from the end of each match
+TEST(SearchTests, AgreesWithFind) {
+  std::mt19937 gen(5);
+  std::uniform_int_distribution<int> letter('a', 'd');
+
+  std::string text(3 * Searcher::Window + 17, 'a');
+  for (char &c : text)
+    c = static_cast<char>(letter(gen));
+  const std::span<const uint8_t> bytes(
+      reinterpret_cast<const uint8_t *>(text.data()), text.size());
+
+  for (std::string_view expression :
+       {"a*b(c|d)", "(a|b)*c", "ab|b|bcd", "a(b|c)*d|c", "a|a*d"}) {
+    const Searcher searcher(Parse(expression));
+
+    std::vector<MatchSpan> expected;
+    for (size_t from = 0;;) {
+      const std::optional<MatchSpan> match = searcher.Find(bytes, from);
+      if (!match)
+        break;
+      expected.push_back(*match);
+      from = match->end;
+    }
+
+    ASSERT_EQ(searcher.FindAll(bytes), expected) << expression;
+  }
+}
+
+TEST(SearchTests, AgreesWithBruteForce) {
+  std::mt19937 gen(3);
+  std::uniform_int_distribution<int> letter('a', 'd');
+
+  for (std::string_view expression :
+       {"a*b(c|d)", "(a|b)*c", "ab|b|bcd", "(ab)*", "a(b|c)*d|c", "d*",
+        "a|a*b", "(a|b)*cd|b"}) {
+    Regex::Matcher reg(expression);
+
+    for (int i = 0; i < 50; ++i) {
+      std::string text(i % 17, 'a');
+      for (char &c : text)
+        c = static_cast<char>(letter(gen));
+
+      ASSERT_EQ(reg.FindAll(text), BruteForce(reg, text))
+          << expression << " on " << text;
+
+      std::vector<MatchSpan> all = BruteForce(reg, text);
+      std::optional<MatchSpan> first = reg.Find(text);
+      if (all.empty())
+        ASSERT_EQ(first, std::nullopt);
+      else
+        ASSERT_EQ(first, all.front()) << expression << " on " << text;
+    }
+  }
+}
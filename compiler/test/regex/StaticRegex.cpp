@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "regex/Regex.hpp"
+#include "regex/StaticRegex.hpp"
+
+namespace {
+
+using Abb = Regex::StaticMatcher<"(a|b)*abb">;
+using Hex = Regex::StaticMatcher<"0x[0-9a-fA-F]{1,8}">;
+using Greek = Regex::StaticMatcher<"[α-ω]+">;
+using Nothing = Regex::StaticMatcher<"">;
+
+// Compiled and matched entirely by the compiler
+static_assert(Abb::Match("abb"));
+static_assert(Abb::Match("babaabb"));
+static_assert(!Abb::Match("abba"));
+static_assert(!Abb::Match(""));
+static_assert(Hex::Match("0xBEEF"));
+static_assert(!Hex::Match("0x"));
+static_assert(!Hex::Match("0x123456789"));
+static_assert(!Nothing::Match(""));
+
+// The textbook minimal DFA for (a|b)*abb has 4 states, plus the dead one
+static_assert(Abb::NumStates() == 5);
+static_assert(Nothing::NumStates() == 1);
+
+// Random strings over the characters the pattern uses, checked against a
+// runtime Matcher of the same pattern
+template <typename Static>
+void AgreesWithMatcher(std::string_view alphabet, uint32_t seed) {
+  Regex::Matcher reg(Static::Expression());
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<size_t> letter(0, alphabet.size() - 1);
+
+  for (int i = 0; i < 500; ++i) {
+    std::string text(i % 12, ' ');
+    for (char &c : text)
+      c = alphabet[letter(gen)];
+
+    ASSERT_EQ(Static::Match(text), reg.Match(text))
+        << Static::Expression() << " on " << text;
+  }
+}
+
+} // namespace
+
+TEST(StaticRegexTests, Utf8) {
+  ASSERT_TRUE(Greek::Match("αβγ"));
+  ASSERT_FALSE(Greek::Match("αbγ"));
+  // Half of a two byte encoding
+  ASSERT_FALSE(Greek::Match(std::string_view("α", 1)));
+}
+
+TEST(StaticRegexTests, AgreesWithMatcher) {
+  AgreesWithMatcher<Abb>("ab", 1);
+  AgreesWithMatcher<Hex>("0x1aFgG", 2);
+  AgreesWithMatcher<Regex::StaticMatcher<"(ab|a)(c|bcd)(d*)">>("abcd", 3);
+  AgreesWithMatcher<Regex::StaticMatcher<"([a-c]+|d?e){2,3}">>("abcde", 4);
+  AgreesWithMatcher<Regex::StaticMatcher<"a|b|(ab)*">>("ab", 5);
+}
+
+// The patterns a Matcher rejects. At compile time these fail the build, so
+// they're checked by running the same constexpr front end at runtime
+TEST(StaticRegexTests, BadPatterns) {
+  for (std::string_view pattern :
+       {"a)b", "ab]", "a||b", "a|", "|a", "(a", "a{2,1}", "[z-a]", "*"}) {
+    ASSERT_THROW(Regex::Static::Compile(pattern), Regex::ParseError)
+        << pattern;
+    ASSERT_THROW(Regex::Matcher{pattern}, Regex::ParseError) << pattern;
+  }
+}
+
+// Tables are only as wide as the classes and states need: below 'a', 'a',
+// 'b' and above 'b', with states in single bytes
+TEST(StaticRegexTests, TableSize) {
+  ASSERT_EQ(Abb::NumClasses(), 4);
+  ASSERT_EQ(Abb::MemoryUsage(), 256 + 5 * 4 + 5 + 1);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "regex/Regex.hpp"
+#include "regex/Stats.hpp"
+
+TEST(StatsTests, CompileStats) {
+  if constexpr (!StatsEnabled)
+    GTEST_SKIP() << "built with REGEX_STATS=0";
+
+  Regex::Matcher reg("(a|b)*abb");
+  const CompileStats &stats = reg.Stats().compile;
+
+  ASSERT_GT(stats.nfa_states, 0);
+  ASSERT_GT(stats.nfa_transitions, 0);
+  ASSERT_GT(stats.nfa_bytes, 0);
+  ASSERT_GE(stats.dfa_states, stats.min_states);
+  ASSERT_EQ(stats.min_states, 4);
+  ASSERT_GT(stats.min_transitions, 0);
+  ASSERT_GT(stats.epsilon_closures, 0);
+  ASSERT_GT(stats.table_bytes, 0);
+  ASSERT_GT(stats.determinize_peak_bytes, 0);
+  ASSERT_GT(stats.minimize_peak_bytes, 0);
+
+  // The subsets of (a|b)*a(a|b)^n blow up exponentially, and so does the
+  // memory it takes to build them
+  Regex::Matcher nth("(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)");
+  const CompileStats &blowup = nth.Stats().compile;
+  ASSERT_GT(blowup.determinize_peak_bytes,
+            16 * stats.determinize_peak_bytes);
+  ASSERT_GT(blowup.minimize_peak_bytes, 16 * stats.minimize_peak_bytes);
+
+  // Only the NFA is built up front by the other engines
+  Regex::Matcher nfa("(a|b)*abb", Regex::Engine::Nfa);
+  ASSERT_EQ(nfa.Stats().compile.nfa_states, stats.nfa_states);
+  ASSERT_EQ(nfa.Stats().compile.dfa_states, 0);
+}
+
+TEST(StatsTests, MatchStats) {
+  if constexpr (!StatsEnabled)
+    GTEST_SKIP() << "built with REGEX_STATS=0";
+
+  for (Regex::Engine engine : {Regex::Engine::Dfa, Regex::Engine::LazyDfa,
+                               Regex::Engine::Nfa}) {
+    Regex::Matcher reg("abc*", engine);
+
+    // Nothing is counted until asked for
+    reg.Match("abccc");
+    ASSERT_EQ(reg.Stats().match.matches, 0);
+
+    reg.CollectMatchStats(true);
+    ASSERT_TRUE(reg.Match("abccc"));
+    ASSERT_FALSE(reg.Match("axccc"));
+    ASSERT_FALSE(reg.Match("abd"));
+    reg.CollectMatchStats(false);
+    reg.Match("abc");
+
+    const MatchStats &stats = reg.Stats().match;
+    ASSERT_EQ(stats.matches, 3);
+    // All of the first, up to the x of the second, all of the third
+    ASSERT_EQ(stats.steps, 5 + 2 + 3);
+    ASSERT_EQ(stats.dead_exits, 2);
+  }
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "regex/LangFrontend.hpp"
+#include "regex/Regex.hpp"
+#include "regex/TaggedDFA.hpp"
+
+namespace {
+
+using Groups = std::vector<std::optional<MatchSpan>>;
+
+FSA Tagged(std::string_view expression, uint64_t &n_tags) {
+  Regex::Lexer lex(expression);
+  Regex::Parser parser(lex.Lex(), true);
+  FSA fsa = parser.Parse();
+  n_tags = 2 * parser.NumGroups();
+  return fsa;
+}
+
+/*
+ * Backtracking over the tagged NFA, trying transitions in order. A state is
+ * never tried twice at the same position, which is what makes a Pike VM and
+ * the tagged DFA prefer the same path
+ */
+class Backtracker {
+private:
+  const FSA &fsa;
+  std::string_view input;
+  std::set<std::pair<uint64_t, size_t>> tried;
+
+public:
+  std::vector<size_t> tags;
+
+  Backtracker(const FSA &fsa, std::string_view input, uint64_t n_tags)
+      : fsa(fsa), input(input), tags(n_tags, TaggedDFA::NoPosition) {}
+
+  bool Run(uint64_t state, size_t position) {
+    if (!tried.emplace(state, position).second)
+      return false;
+
+    if (position == input.size() && fsa.IsAcceptState(state))
+      return true;
+
+    for (const FSA::Transition &trans : fsa.TransitionsFrom(state)) {
+      if (FSA::IsTag(trans.label)) {
+        const uint64_t tag = FSA::TagOf(trans.label);
+        const size_t saved = tags[tag];
+        tags[tag] = position;
+        if (Run(trans.to, position))
+          return true;
+        tags[tag] = saved;
+      } else if (trans.label == FSA::Eps) {
+        if (Run(trans.to, position))
+          return true;
+      } else if (position < input.size() &&
+                 trans.Covers(static_cast<uint8_t>(input[position]))) {
+        if (Run(trans.to, position + 1))
+          return true;
+      }
+    }
+
+    return false;
+  }
+};
+
+Groups Captures(Regex::Matcher &reg, std::string_view input) {
+  Groups groups(reg.NumGroups());
+  if (!reg.Match(input, groups))
+    return {};
+  return groups;
+}
+
+} // namespace
+
+TEST(TaggedDFATests, Groups) {
+  Regex::Matcher reg("(a*)(b|c)(d)");
+
+  ASSERT_EQ(reg.NumGroups(), 4);
+  ASSERT_EQ(Captures(reg, "aacd"),
+            (Groups{MatchSpan{0, 4}, MatchSpan{0, 2}, MatchSpan{2, 3},
+                    MatchSpan{3, 4}}));
+  ASSERT_EQ(Captures(reg, "bd"), (Groups{MatchSpan{0, 2}, MatchSpan{0, 0},
+                                         MatchSpan{0, 1}, MatchSpan{1, 2}}));
+  ASSERT_TRUE(Captures(reg, "aab").empty());
+}
+
+TEST(TaggedDFATests, UnusedGroupsAndLastIteration) {
+  Regex::Matcher alt("(a)|(b)");
+  ASSERT_EQ(Captures(alt, "b"),
+            (Groups{MatchSpan{0, 1}, std::nullopt, MatchSpan{0, 1}}));
+
+  Regex::Matcher star("((a|b)c)*");
+  ASSERT_EQ(Captures(star, "acbcac"),
+            (Groups{MatchSpan{0, 6}, MatchSpan{4, 6}, MatchSpan{4, 5}}));
+  ASSERT_EQ(Captures(star, ""),
+            (Groups{MatchSpan{0, 0}, std::nullopt, std::nullopt}));
+}
+
+// Stars take as much as they can, alternatives are tried left to right
+TEST(TaggedDFATests, GreedyAndLeftmost) {
+  Regex::Matcher greedy("(a*)(a*)");
+  ASSERT_EQ(Captures(greedy, "aaa"),
+            (Groups{MatchSpan{0, 3}, MatchSpan{0, 3}, MatchSpan{3, 3}}));
+
+  Regex::Matcher alternatives("(a|ab)(c|bcd)(d*)");
+  ASSERT_EQ(Captures(alternatives, "abcd"),
+            (Groups{MatchSpan{0, 4}, MatchSpan{0, 1}, MatchSpan{1, 4},
+                    MatchSpan{4, 4}}));
+}
+
+TEST(TaggedDFATests, FindCaptures) {
+  Regex::Matcher reg("(cat|dog)(s)*");
+  Groups groups(reg.NumGroups());
+
+  ASSERT_EQ(reg.Find("hotdogss!", groups), (MatchSpan{3, 8}));
+  ASSERT_EQ(groups, (Groups{MatchSpan{3, 8}, MatchSpan{3, 6},
+                            MatchSpan{7, 8}}));
+  ASSERT_EQ(reg.Find("cow", groups), std::nullopt);
+}
+
+TEST(TaggedDFATests, AgreesWithBacktracking) {
+  std::mt19937 gen(16);
+  std::uniform_int_distribution<int> letter('a', 'c');
+
+  for (std::string_view expression :
+       {"(a|ab)(c|bcd)(d*)", "((a)|b)*(c)", "(a*)(ab)*(b*)", "(a(b)*|c)*",
+        "((ab)|(a)(b))*c*", "(a|b)*(ab|b)", "(a|b){1,3}(b?)",
+        "([a-b]+)(c?)([ac]{2,})?"}) {
+    uint64_t n_tags;
+    FSA fsa = Tagged(expression, n_tags);
+    TaggedDFA dfa(fsa, n_tags);
+    std::vector<size_t> tags(n_tags);
+
+    for (int i = 0; i < 200; ++i) {
+      std::string text(i % 8, 'a');
+      for (char &c : text)
+        c = static_cast<char>(letter(gen));
+
+      Backtracker reference(fsa, text, n_tags);
+      const bool expected = reference.Run(fsa.StartState(), 0);
+
+      ASSERT_EQ(dfa.Match(text, tags), expected)
+          << expression << " on " << text;
+      if (expected) {
+        ASSERT_EQ(tags, reference.tags) << expression << " on " << text;
+      }
+    }
+  }
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Common.hpp"
+#include "regex/FSA.hpp"
+#include "regex/Regex.hpp"
+#include "regex/Utf8.hpp"
+
+namespace {
+
+std::string Encode(char32_t cp) {
+  std::string res;
+  switch (Utf8::EncodedLength(cp)) {
+  case 1:
+    res += static_cast<char>(cp);
+    break;
+  case 2:
+    res += static_cast<char>(0xC0 | (cp >> 6));
+    res += static_cast<char>(0x80 | (cp & 0x3F));
+    break;
+  case 3:
+    res += static_cast<char>(0xE0 | (cp >> 12));
+    res += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    res += static_cast<char>(0x80 | (cp & 0x3F));
+    break;
+  default:
+    res += static_cast<char>(0xF0 | (cp >> 18));
+    res += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    res += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    res += static_cast<char>(0x80 | (cp & 0x3F));
+    break;
+  }
+  return res;
+}
+
+bool IsSurrogate(char32_t cp) {
+  return cp >= Utf8::SurrogateBegin && cp <= Utf8::SurrogateEnd;
+}
+
+FSA Minimal(std::string_view expression) {
+  FSA fsa = Parse(expression);
+  fsa.Determinize();
+  fsa.Minimize();
+  return fsa;
+}
+
+} // namespace
+
+TEST(Utf8Tests, Decode) {
+  char32_t cp;
+  ASSERT_EQ(Utf8::Decode("a", cp), 1);
+  ASSERT_TRUE(cp == U'a');
+  ASSERT_EQ(Utf8::Decode("\xc3\xa9", cp), 2);
+  ASSERT_TRUE(cp == U'é');
+  ASSERT_EQ(Utf8::Decode("\xe4\xb8\x80z", cp), 3);
+  ASSERT_TRUE(cp == U'一');
+  ASSERT_EQ(Utf8::Decode("\xf4\x8f\xbf\xbf", cp), 4);
+  ASSERT_TRUE(cp == Utf8::MaxCodePoint);
+
+  // Overlong, surrogate, too large, truncated, stray continuation byte
+  ASSERT_EQ(Utf8::Decode("\xc0\x80", cp), 0);
+  ASSERT_EQ(Utf8::Decode("\xed\xa0\x80", cp), 0);
+  ASSERT_EQ(Utf8::Decode("\xf4\x90\x80\x80", cp), 0);
+  ASSERT_EQ(Utf8::Decode("\xe4\xb8", cp), 0);
+  ASSERT_EQ(Utf8::Decode("\x80", cp), 0);
+}
+
+// Every code point is in exactly the sequences of the ranges containing it
+TEST(Utf8Tests, SequencesCoverRange) {
+  for (auto [lo, hi] : {std::pair<char32_t, char32_t>{0, Utf8::MaxCodePoint},
+                        {0x7F, 0x800},
+                        {0x3FF, 0xD7FF},
+                        {0xD000, 0xE0FF},
+                        {0x10400, 0x10FFFE}}) {
+    const auto seqs = Utf8::Sequences(lo, hi);
+
+    for (char32_t cp = 0; cp <= Utf8::MaxCodePoint; ++cp) {
+      if (IsSurrogate(cp))
+        continue;
+
+      const std::string bytes = Encode(cp);
+      int matches{0};
+      for (const Utf8::Sequence &seq : seqs) {
+        if (seq.length != bytes.size())
+          continue;
+        bool all{true};
+        for (size_t i = 0; i < bytes.size(); ++i) {
+          const uint8_t byte = bytes[i];
+          all = all && seq.ranges[i].lo <= byte && byte <= seq.ranges[i].hi;
+        }
+        matches += all;
+      }
+
+      ASSERT_EQ(matches, lo <= cp && cp <= hi)
+          << std::hex << static_cast<uint32_t>(cp);
+    }
+  }
+}
+
+TEST(Utf8Tests, MatchCodePoints) {
+  Regex::Matcher greek("[α-ω]+ς?");
+  ASSERT_TRUE(greek.Match("αβγ"));
+  ASSERT_FALSE(greek.Match("λόγος"));
+  ASSERT_TRUE(greek.Match("λογς"));
+  ASSERT_FALSE(greek.Match("abc"));
+  ASSERT_FALSE(greek.Match("\xce"));
+
+  // Repetition applies to the whole character, not its last byte
+  Regex::Matcher repeated("é{2}");
+  ASSERT_TRUE(repeated.Match("éé"));
+  ASSERT_FALSE(repeated.Match("é\xa9"));
+
+  ASSERT_THROW(Regex::Matcher("a\xff"), Regex::ParseError);
+  ASSERT_THROW(Regex::Matcher("[\xed\xa0\x80]"), Regex::ParseError);
+}
+
+TEST(Utf8Tests, ClassAgreesWithCodePoints) {
+  Regex::Matcher reg("[Ā-\U0001F000a-z]");
+
+  for (char32_t cp = 0; cp <= Utf8::MaxCodePoint; ++cp) {
+    if (IsSurrogate(cp))
+      continue;
+    const bool expected =
+        (cp >= 0x100 && cp <= 0x1F000) || (cp >= 'a' && cp <= 'z');
+    ASSERT_EQ(reg.Match(Encode(cp)), expected)
+        << std::hex << static_cast<uint32_t>(cp);
+  }
+
+  // Never matches the encoding of a surrogate
+  ASSERT_FALSE(reg.Match("\xed\xa0\x80"));
+}
+
+// All of Unicode is a handful of states and arcs, not a million of either
+TEST(Utf8Tests, CompactAutomaton) {
+  FSA fsa = Minimal("[\x01-\U0010FFFF]");
+
+  uint64_t arcs{0};
+  for (uint64_t state = 0; state < fsa.NumStates(); ++state)
+    arcs += fsa.TransitionsFrom(state).size();
+
+  ASSERT_EQ(fsa.NumStates(), 9);
+  ASSERT_LE(arcs, 20);
+}